@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "fastio.hpp"
+
+using namespace std;
+
+// Synthetic graphs for the benchmark, written to stdout in the input format of TP1:
+//   path n                 a path 1-2-...-n, the deepest possible DFS
+//   grid rows cols         a rows x cols grid, one big cluster
+//   sgrid rows cols seed   the same grid with the vertex ids randomly permuted, as ids come in
+//                          real data; the case vertex reordering (-r) is for
+//   gnm n m seed           m edges between uniformly random distinct vertices
+//   rmat scale m seed      m edges of an R-MAT graph with 2^scale vertices (power-law degrees)
+//   blocks k size seed     k cycles of size vertices, each glued by one vertex to a random
+//                          earlier cycle: many tiny clusters and links
+
+typedef vector<pair<uint32_t, uint32_t>> EdgeList;
+
+void path(EdgeList &edges, uint32_t n) {
+    for (uint32_t v = 1; v < n; v++) {
+        edges.push_back({v, v + 1});
+    }
+}
+
+void grid(EdgeList &edges, uint32_t rows, uint32_t cols) {
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < cols; c++) {
+            uint32_t v = r * cols + c + 1;
+            if (c + 1 < cols) edges.push_back({v, v + 1});
+            if (r + 1 < rows) edges.push_back({v, v + cols});
+        }
+    }
+}
+
+void gnm(EdgeList &edges, uint32_t n, uint32_t m, mt19937_64 &random) {
+    uniform_int_distribution<uint32_t> vertex(1, n);
+    while (edges.size() < m) {
+        uint32_t u = vertex(random), v = vertex(random);
+        if (u != v) edges.push_back({u, v});
+    }
+}
+
+// Each edge picks one quadrant of the adjacency matrix per bit of the ids, with the usual
+// probabilities a = 0.57, b = 0.19, c = 0.19, d = 0.05
+void rmat(EdgeList &edges, uint32_t scale, uint32_t m, mt19937_64 &random) {
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    while (edges.size() < m) {
+        uint32_t u = 0, v = 0;
+        for (uint32_t bit = 0; bit < scale; bit++) {
+            double p = unit(random);
+            u = 2 * u + (p >= 0.76 ? 1 : 0);
+            v = 2 * v + ((p >= 0.57 && p < 0.76) || p >= 0.95 ? 1 : 0);
+        }
+        if (u != v) edges.push_back({u + 1, v + 1});
+    }
+}
+
+void blocks(EdgeList &edges, uint32_t k, uint32_t size, mt19937_64 &random) {
+    uint32_t n = 1;
+    for (uint32_t b = 0; b < k; b++) {
+        uint32_t first = uniform_int_distribution<uint32_t>(1, n)(random);
+        uint32_t previous = first;
+        for (uint32_t i = 1; i < size; i++) {
+            edges.push_back({previous, ++n});
+            previous = n;
+        }
+        if (size > 2) edges.push_back({previous, first});
+    }
+}
+
+int main(int argc, char *argv[]) {
+    auto argument = [&](int i) { return i < argc ? (uint32_t)strtoul(argv[i], nullptr, 10) : 0; };
+    const char *kind = argc > 1 ? argv[1] : "";
+    mt19937_64 random(argument(4));
+
+    EdgeList edges;
+    uint32_t n = 0;
+    if (strcmp(kind, "path") == 0 && argc == 3) {
+        n = argument(2);
+        path(edges, n);
+    } else if (strcmp(kind, "grid") == 0 && argc == 4) {
+        n = argument(2) * argument(3);
+        grid(edges, argument(2), argument(3));
+    } else if (strcmp(kind, "sgrid") == 0 && argc == 5) {
+        n = argument(2) * argument(3);
+        grid(edges, argument(2), argument(3));
+        vector<uint32_t> ids(n + 1);
+        for (uint32_t v = 0; v <= n; v++) ids[v] = v;
+        shuffle(ids.begin() + 1, ids.end(), random);
+        for (pair<uint32_t, uint32_t> &edge : edges) {
+            edge = {ids[edge.first], ids[edge.second]};
+        }
+    } else if (strcmp(kind, "gnm") == 0 && argc == 5 && argument(2) > 1) {
+        n = argument(2);
+        gnm(edges, n, argument(3), random);
+    } else if (strcmp(kind, "rmat") == 0 && argc == 5 && argument(2) > 0 && argument(2) < 31) {
+        n = 1u << argument(2);
+        rmat(edges, argument(2), argument(3), random);
+    } else if (strcmp(kind, "blocks") == 0 && argc == 5 && argument(3) >= 2) {
+        n = 1 + argument(2) * (argument(3) - 1);
+        blocks(edges, argument(2), argument(3), random);
+    } else {
+        fprintf(stderr, "Usage: %s path n | grid rows cols | sgrid rows cols seed | gnm n m seed | rmat scale m seed | blocks k size seed\n", argv[0]);
+        return 1;
+    }
+
+    FastWriter writer;
+    writer.writeInt(n);
+    writer.writeChar(' ');
+    writer.writeInt(edges.size());
+    writer.writeChar('\n');
+    for (const pair<uint32_t, uint32_t> &edge : edges) {
+        writer.writeInt(edge.first);
+        writer.writeChar(' ');
+        writer.writeInt(edge.second);
+        writer.writeChar('\n');
+    }
+    writer.flush();
+    return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Benchmark of TP1 on synthetic graphs of about SIZE vertices. Every graph is generated once
+# and solved REPS times with -f -t in each vertex order (input, then -r bfs, rcm and degree);
+# each run appends one row to the CSV file:
+#   label,graph,order,vertices,edges,repetition,parse_ms,build_ms,clusters_ms,sort_ms,output_ms,cache_misses
+# The label (by default the current git commit) tells builds apart when tracking regressions.
+# cache_misses is filled when perf is installed and left empty otherwise.
+#
+# Usage: run.sh main generate size reps csv [label]
+
+if [ $# -lt 5 ]; then
+    echo "Usage: $0 main generate size reps csv [label]" >&2
+    exit 1
+fi
+MAIN=$1
+GENERATE=$2
+SIZE=$3
+REPS=$4
+CSV=$5
+LABEL=${6:-$(git rev-parse --short HEAD 2>/dev/null || echo unknown)}
+
+SIDE=$(awk -v n="$SIZE" 'BEGIN { print int(sqrt(n)) }')
+SCALE=$(awk -v n="$SIZE" 'BEGIN { s = int(log(n) / log(2)); print s < 1 ? 1 : s }')
+DATA=$(mktemp -d)
+trap 'rm -rf "$DATA"' EXIT
+
+if [ ! -f "$CSV" ]; then
+    echo "label,graph,order,vertices,edges,repetition,parse_ms,build_ms,clusters_ms,sort_ms,output_ms,cache_misses" > "$CSV"
+fi
+
+bench() {
+    NAME=$1
+    shift
+    "$GENERATE" "$@" > "$DATA/$NAME.txt" || exit 1
+    COUNTS=$(head -n 1 "$DATA/$NAME.txt" | tr ' ' ',')
+    for ORDER in input bfs rcm degree; do
+        if [ "$ORDER" = input ]; then FLAGS=""; else FLAGS="-r $ORDER"; fi
+        for REP in $(seq 1 "$REPS"); do
+            MISSES=""
+            if command -v perf > /dev/null 2>&1; then
+                TIMES=$(perf stat -x, -e cache-misses -o "$DATA/perf.txt" "$MAIN" -f -t $FLAGS -i "$DATA/$NAME.txt" 2>&1 > /dev/null) || exit 1
+                MISSES=$(grep cache-misses "$DATA/perf.txt" | cut -d, -f1)
+            else
+                TIMES=$("$MAIN" -f -t $FLAGS -i "$DATA/$NAME.txt" 2>&1 > /dev/null) || exit 1
+            fi
+            echo "$LABEL,$NAME,$ORDER,$COUNTS,$REP,$TIMES,$MISSES" | tee -a "$CSV"
+        done
+    done
+}
+
+bench path path "$SIZE"
+bench grid grid "$SIDE" "$SIDE"
+bench sgrid sgrid "$SIDE" "$SIDE" 1
+bench gnm gnm "$SIZE" $((4 * SIZE)) 1
+bench rmat rmat "$SCALE" $((8 * (1 << SCALE))) 1
+bench blocks blocks $((SIZE / 3)) 4 1
@@ -0,0 +1,756 @@
+#ifndef BICONNECTIVITY_HPP
+#define BICONNECTIVITY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+// Articulation points (links) and biconnected components (clusters, or blocks) of an
+// undirected graph, as a header-only template:
+//  - Id is the integer type of vertex ids, edge indexes and CSR positions: uint32_t keeps
+//    every array compact, uint64_t allows graphs with more than 2^31 vertices or edges;
+//  - Graph is any view with indexable offsets, targets and edges in compressed sparse row
+//    form (see CSRGraphView), so the arrays may live in vectors, a mapped file or elsewhere;
+//  - Visitor receives articulationPoint(vertex) when a vertex is found to be a link and
+//    block(cluster, members, count) when the vertices of a cluster are known.
+// Vertices are 0-based in the graph; the members of the clusters are stored 1-based, as the
+// program prints them. Every buffer is kept between graphs and only cleared by reset, so
+// a caller that handles many graphs allocates memory only for a graph larger than the
+// previous ones.
+
+// Graph in compressed sparse row form: the vertices adjacent to vertex v (0-based) are
+// targets[offsets[v]] .. targets[offsets[v+1]-1], and edges[k] is the index in the input of
+// the edge stored at position k. The arrays are owned elsewhere.
+template <class Id>
+struct CSRGraphView {
+    const Id *offsets;
+    const Id *targets;
+    const Id *edges;
+};
+
+// Arrays of a CSR graph built in memory from an edge list
+template <class Id>
+struct CSRStorage {
+    std::vector<Id> offsets;
+    std::vector<Id> targets;
+    std::vector<Id> edges;
+
+    CSRGraphView<Id> view() const {
+        return {offsets.data(), targets.data(), edges.data()};
+    }
+};
+
+// Builds the CSR graph from the edge list (pairs of 1-based endpoints) in two passes:
+// the degrees are counted and turned into offsets by a prefix sum, then the edges are
+// written backwards, moving each offset from the end to the start of its vertex. This
+// keeps the adjacent vertices in input order without a second array of positions.
+template <class Id>
+void buildCSR(CSRStorage<Id> &graph, Id nVertexs, const std::vector<Id> &endpoints) {
+    graph.offsets.assign((size_t)nVertexs + 1, 0);
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        graph.offsets[endpoints[i] - 1]++;
+    }
+    for (Id v = 1; v <= nVertexs; v++) {
+        graph.offsets[v] += graph.offsets[v-1];
+    }
+
+    graph.targets.resize(endpoints.size());
+    graph.edges.resize(endpoints.size());
+    for (size_t i = endpoints.size(); i > 0; i -= 2) {
+        Id Vertex1 = endpoints[i-2] - 1, Vertex2 = endpoints[i-1] - 1;
+        Id edge = (Id)(i/2 - 1);
+        Id position = --graph.offsets[Vertex2];
+        graph.targets[position] = Vertex1;
+        graph.edges[position] = edge;
+        position = --graph.offsets[Vertex1];
+        graph.targets[position] = Vertex2;
+        graph.edges[position] = edge;
+    }
+}
+
+// Visitor that ignores every callback
+struct NoVisitor {
+    template <class Id>
+    void articulationPoint(Id) {}
+
+    template <class Id>
+    void block(Id, const Id *, size_t) {}
+};
+
+// Times of a vertex in the DFS
+template <class Id>
+class Vertex {
+public:
+    Id discoveryTime; // Time when the vertex was discovered during DFS
+    Id lowLink; // Lowest discovery time reachable from the vertex
+    Vertex() : discoveryTime(0), lowLink(std::numeric_limits<Id>::max()) {}
+
+    void updateDiscoveryTime(Id newTime) {
+        discoveryTime = newTime;
+    }
+
+    void updateLowLink(Id newLow) {
+        lowLink = std::min(lowLink, newLow);
+    }
+};
+
+template <class Id, class Graph = CSRGraphView<Id>, class Visitor = NoVisitor>
+class Biconnectivity {
+public:
+    static constexpr Id NONE = std::numeric_limits<Id>::max();
+
+    Visitor visitor;
+
+    std::vector<Vertex<Id>> vertices;
+    std::vector<char> isLink; // Whether each vertex is a link (articulation point); scanned in ascending order for the output
+    Id nLinks = 0;
+    Id nClusters = 0;
+    std::vector<Id> blockOf; // Cluster of each input edge, numbered from 1 in the order the clusters are found (0 for self-loops)
+
+    // Arena with the vertices of every cluster, in the order the clusters are found: cluster c
+    // (0-based) has the sorted vertices clusterMembers[clusterOffsets[c]] .. clusterMembers[clusterOffsets[c+1]-1]
+    std::vector<Id> clusterOffsets = std::vector<Id>(1, 0);
+    std::vector<Id> clusterMembers;
+
+    // Block-cut forest filled by buildForest: the clusters containing link v (0-based) are the
+    // ranks forestClusters[forestOffsets[v]] .. forestClusters[forestOffsets[v+1]-1] in the cluster order
+    std::vector<Id> forestOffsets;
+    std::vector<Id> forestClusters;
+
+    // Bridges and 2-edge-connected components, filled by the DFS when reset is given withBridges.
+    // A tree edge is a bridge when no back edge leaves the subtree below it; the vertices of a
+    // component are kept on a stack and popped when the DFS returns over a bridge or a root.
+    std::vector<char> isBridge; // Whether each input edge is a bridge
+    Id nBridges = 0;
+    std::vector<Id> edgeComponentOf; // 2-edge-connected component of each vertex (0-based), numbered from 1 in the order found
+    Id nEdgeComponents = 0;
+
+    // Work of the DFS, added up over every run until the caller clears it. Pushes are counted
+    // in a local and added once per DFS tree, pops once per cluster, so the inner loop only
+    // pays a register increment. The parallel algorithm has no edge stack and only counts clusters.
+    struct Counters {
+        uint64_t edgesPushed = 0;  // Tree and back edges pushed on the edge stack
+        uint64_t edgesPopped = 0;  // Edges popped into clusters
+        uint64_t clusters = 0;     // Clusters found
+        uint64_t maxEdgeStack = 0; // Largest edge stack, seen before each cluster is popped
+    };
+    Counters counters;
+
+    // Clears the state for a graph with nVertexs vertices and nEdges edges; when withClusters
+    // is false only blockOf is filled and the visitor gets no blocks. withBridges also fills the
+    // bridges and the 2-edge-connected components, which only the DFS does. withEdgeLabels false
+    // leaves blockOf empty and has the DFS pop the clusters from a stack of vertices instead of
+    // edges, so every buffer is O(nVertexs) however many edges the graph has (DFS only).
+    void reset(Id nVertexs, Id nEdges, bool withClusters, bool withBridges = false, bool withEdgeLabels = true) {
+        vertices.assign(nVertexs, Vertex<Id>());
+        isLink.assign(nVertexs, 0);
+        clusterMark.assign(nVertexs, 0);
+        blockOf.assign(withEdgeLabels ? nEdges : 0, 0);
+        labelEdges = withEdgeLabels;
+        vertexStack.clear();
+        nLinks = 0;
+        nClusters = 0;
+        buildClusters = withClusters;
+        buildBridges = withBridges;
+        isBridge.assign(withBridges ? nEdges : 0, 0);
+        edgeComponentOf.assign(withBridges ? nVertexs : 0, 0);
+        nBridges = 0;
+        nEdgeComponents = 0;
+        componentStack.clear();
+        edgeStack.clear();
+        dfsStack.clear();
+        clusterOffsets.assign(1, 0);
+        clusterMembers.clear();
+    }
+
+    // Finds the articulation points and clusters with the DFS or, when pool is given, with
+    // the parallel Tarjan-Vishkin algorithm. The parallel algorithm always builds the clusters.
+    void run(const Graph &graph, Id nVertexs, ThreadPool *pool = nullptr) {
+        if (pool != nullptr) {
+            parallelClusters(graph, nVertexs, *pool);
+            return;
+        }
+
+        // Perform DFS to identify articulation points and clusters
+        Id time = 0;
+        for (Id i = 0; i < nVertexs; i++) {
+            if (vertices[i].discoveryTime == 0) {
+                dfs(graph, i, time);
+            }
+            if (!edgeStack.empty()) {
+                findClusters(graph, NONE);
+            }
+        }
+    }
+
+    // Translates the result of a run on a graph with renamed vertices back to the original ids,
+    // where originalId[v] is the original id of the vertex v (0-based): links and cluster
+    // members are renamed and the members of every cluster sorted again. blockOf needs nothing,
+    // as edges keep their input index; the order the clusters were found in stays that of the
+    // renamed graph. Must be called before sortClusters and buildForest.
+    void restoreIds(Id nVertexs, const std::vector<Id> &originalId) {
+        std::vector<char> renamedLinks(nVertexs, 0);
+        for (Id v = 0; v < nVertexs; v++) {
+            renamedLinks[originalId[v]] = isLink[v];
+        }
+        isLink.swap(renamedLinks);
+        for (Id &member : clusterMembers) {
+            member = originalId[member - 1] + 1;
+        }
+        for (Id c = 0; c < nClusters; c++) {
+            std::sort(clusterMembers.begin() + clusterOffsets[c], clusterMembers.begin() + clusterOffsets[c+1]);
+        }
+    }
+
+    // Returns the clusters in lexicographic order. Ou seja, se temos os clusters a = {1, 3, 7} e
+    // b = {1, 2, 100}, o cluster b deve ser listado antes do cluster a, e, portanto, possuir um
+    // identificador menor. Every cluster has at least two vertices and two clusters share at most
+    // one vertex, so the first two vertices already decide the order and a radix sort on them
+    // (second vertex, then first) is enough. Runs with the same first two vertices cannot come
+    // from biconnected components, but are still finished by a full comparison to keep the order exact.
+    const std::vector<Id> &sortClusters(Id nVertexs) {
+        order.resize(nClusters);
+        sorted.resize(nClusters);
+        for (Id c = 0; c < nClusters; c++) {
+            order[c] = c;
+        }
+        countingSortClusters(order, sorted, nVertexs, 1);
+        countingSortClusters(sorted, order, nVertexs, 0);
+
+        auto firstTwo = [this](Id c) {
+            return std::make_pair(clusterMembers[clusterOffsets[c]], clusterMembers[clusterOffsets[c] + 1]);
+        };
+        for (Id begin = 0, end; begin < nClusters; begin = end) {
+            for (end = begin + 1; end < nClusters && firstTwo(order[end]) == firstTwo(order[begin]); end++);
+            if (end - begin > 1) {
+                std::sort(order.begin() + begin, order.begin() + end, [this](Id a, Id b) {
+                    return std::lexicographical_compare(clusterMembers.begin() + clusterOffsets[a], clusterMembers.begin() + clusterOffsets[a+1],
+                                                        clusterMembers.begin() + clusterOffsets[b], clusterMembers.begin() + clusterOffsets[b+1]);
+                });
+            }
+        }
+        return order;
+    }
+
+    // Fills the block-cut forest, which has an edge between each link and each cluster
+    // containing it, listed by link and then by the rank of the cluster in clusterOrder.
+    // Walking the clusters in that order and bucketing the edges by link (offsets from the
+    // counts of a first pass) produces them already sorted.
+    void buildForest(Id nVertexs, const std::vector<Id> &clusterOrder) {
+        forestOffsets.assign((size_t)nVertexs + 1, 0);
+        for (Id k = 0; k < clusterMembers.size(); k++) {
+            Id vertex = clusterMembers[k];
+            if (isLink[vertex-1]) forestOffsets[vertex]++;
+        }
+        for (Id v = 1; v <= nVertexs; v++) {
+            forestOffsets[v] += forestOffsets[v-1];
+        }
+
+        forestClusters.resize(forestOffsets[nVertexs]);
+        forestPosition.assign(forestOffsets.begin(), forestOffsets.end() - 1);
+        for (Id i = 0; i < nClusters; i++) {
+            Id c = clusterOrder[i];
+            for (Id k = clusterOffsets[c]; k < clusterOffsets[c+1]; k++) {
+                Id vertex = clusterMembers[k];
+                if (isLink[vertex-1]) forestClusters[forestPosition[vertex-1]++] = i;
+            }
+        }
+    }
+
+private:
+    typedef std::vector<std::atomic<Id>> AtomicArray;
+
+    // Edge on the DFS edge stack: the vertex it was traversed from and its position in
+    // Graph::targets, which gives both the other endpoint and the edge index
+    struct StackedEdge {
+        Id source;
+        Id position;
+    };
+
+    // Frame of the explicit DFS stack: the vertex being explored and the position in
+    // Graph::targets of the next adjacent vertex to visit. The parent of a frame is the
+    // vertex of the frame right below it, so it does not need to be stored.
+    struct Frame {
+        Id vertex;
+        Id next;
+    };
+
+    std::vector<StackedEdge> edgeStack; // Edges of the clusters still being explored, kept contiguous and reused
+    std::vector<Id> clusterMark; // Last cluster that included each vertex, used to list the vertices of a cluster only once
+    std::vector<Id> clusterVertices; // Vertices of the cluster being popped
+    bool buildClusters = true; // Whether the vertex sets of the clusters are needed, or only blockOf
+    bool buildBridges = false; // Whether the bridges and 2-edge-connected components are needed
+    bool labelEdges = true; // Whether clusters are popped from the edge stack, labeling edges, or from vertexStack
+    std::vector<Id> vertexStack; // Vertices of the clusters still being explored, in discovery order, without edge labels
+    std::vector<Id> componentStack; // Vertices whose 2-edge-connected component is still open, in discovery order
+    std::vector<Frame> dfsStack; // Reused across DFS trees, so the traversal depth is limited only by memory
+    std::vector<Id> order, sorted, counts; // Scratch buffers of sortClusters
+    std::vector<Id> forestPosition; // Scratch buffer of buildForest
+
+    // Marks a vertex (0-based) as a link
+    void addLink(Id indexVertex) {
+        if (!isLink[indexVertex]) {
+            isLink[indexVertex] = 1;
+            nLinks++;
+            visitor.articulationPoint(indexVertex);
+        }
+    }
+
+    // Pops the edges of a cluster from the edge stack, down to and including the edge stored
+    // at position treeEdge of the graph (the whole stack when it is NONE), and labels them
+    // with a new cluster number
+    void findClusters(const Graph &graph, Id treeEdge) {
+        nClusters++;
+        clusterVertices.clear();
+        size_t stacked = edgeStack.size();
+
+        while (!edgeStack.empty()) {
+            StackedEdge edge = edgeStack.back();
+            edgeStack.pop_back();
+            blockOf[graph.edges[edge.position]] = nClusters;
+
+            if (buildClusters) {
+                Id endpoints[2] = {edge.source, graph.targets[edge.position]};
+                for (Id vertex : endpoints) {
+                    if (clusterMark[vertex] != nClusters) {
+                        clusterMark[vertex] = nClusters;
+                        clusterVertices.push_back(vertex + 1);
+                    }
+                }
+            }
+
+            if (edge.position == treeEdge) break;
+        }
+        counters.edgesPopped += stacked - edgeStack.size();
+        counters.clusters++;
+        counters.maxEdgeStack = std::max<uint64_t>(counters.maxEdgeStack, stacked);
+
+        if (buildClusters) {
+            std::sort(clusterVertices.begin(), clusterVertices.end());
+            clusterMembers.insert(clusterMembers.end(), clusterVertices.begin(), clusterVertices.end());
+            clusterOffsets.push_back((Id)clusterMembers.size());
+            visitor.block(nClusters, clusterVertices.data(), clusterVertices.size());
+        }
+    }
+
+    // Pops the vertices of a cluster from the vertex stack, down to and including child; the
+    // cluster is them and the vertex above the tree edge to child
+    void findClusterVertices(Id indexVertex, Id child) {
+        nClusters++;
+        clusterVertices.clear();
+        clusterVertices.push_back(indexVertex + 1);
+        Id vertex;
+        do {
+            vertex = vertexStack.back();
+            vertexStack.pop_back();
+            clusterVertices.push_back(vertex + 1);
+        } while (vertex != child);
+        counters.clusters++;
+
+        std::sort(clusterVertices.begin(), clusterVertices.end());
+        clusterMembers.insert(clusterMembers.end(), clusterVertices.begin(), clusterVertices.end());
+        clusterOffsets.push_back((Id)clusterMembers.size());
+        visitor.block(nClusters, clusterVertices.data(), clusterVertices.size());
+    }
+
+    // Pops the vertices of a 2-edge-connected component from the component stack, down to and
+    // including first, the vertex below the bridge (or the root) where the component starts
+    void findEdgeComponent(Id first) {
+        nEdgeComponents++;
+        Id vertex;
+        do {
+            vertex = componentStack.back();
+            componentStack.pop_back();
+            edgeComponentOf[vertex] = nEdgeComponents;
+        } while (vertex != first);
+    }
+
+    // Stable counting sort of the clusters in input by their vertex at index rank
+    void countingSortClusters(const std::vector<Id> &input, std::vector<Id> &output, Id nVertexs, Id rank) {
+        counts.assign((size_t)nVertexs + 2, 0);
+        for (Id c : input) {
+            counts[clusterMembers[clusterOffsets[c] + rank] + 1]++;
+        }
+        for (Id v = 1; v <= nVertexs + 1; v++) {
+            counts[v] += counts[v-1];
+        }
+        for (Id c : input) {
+            output[counts[clusterMembers[clusterOffsets[c] + rank]]++] = c;
+        }
+    }
+
+    // Updates the parent after the DFS of one of its children has finished. treeEdge is
+    // the position in the graph of the edge from the parent to the child.
+    void finishChild(const Graph &graph, Id indexVertex, Id parent, Id child, Id treeEdge, Id children) {
+        if(vertices[child].lowLink < vertices[indexVertex].lowLink) {
+            vertices[indexVertex].updateLowLink(vertices[child].lowLink);
+        }
+
+        if(parent != NONE && vertices[child].lowLink >= vertices[indexVertex].discoveryTime) {
+            addLink(indexVertex);
+        }
+
+        if (!labelEdges) {
+            // Without an edge stack nothing is left to flush after the tree, so every child of
+            // the root closes its cluster at once
+            if (vertices[child].lowLink >= vertices[indexVertex].discoveryTime) {
+                findClusterVertices(indexVertex, child);
+            }
+        } else if((vertices[indexVertex].discoveryTime == 1 && children > 1) || (vertices[indexVertex].discoveryTime > 1 && vertices[child].lowLink >= vertices[indexVertex].discoveryTime)) {
+            findClusters(graph, treeEdge);
+        }
+
+        // The edge is checked by its index, not by its endpoints, so a parallel edge to the
+        // parent counts as a back edge and keeps the tree edge from being a bridge
+        if(buildBridges && vertices[child].lowLink > vertices[indexVertex].discoveryTime) {
+            isBridge[graph.edges[treeEdge]] = 1;
+            nBridges++;
+            findEdgeComponent(child);
+        }
+    }
+
+    // Depth-first search to identify articulation points and clusters.
+    // The traversal uses an explicit stack instead of recursion, so long path-like graphs
+    // do not overflow the call stack.
+    void dfs(const Graph &graph, Id root, Id time) {
+        Id children = 0; // Children of the root in the DFS tree
+        uint64_t pushed = 0;
+        time++;
+        vertices[root].updateDiscoveryTime(time);
+        vertices[root].updateLowLink(time);
+        dfsStack.push_back({root, graph.offsets[root]});
+        if (buildBridges) componentStack.push_back(root);
+
+        while (!dfsStack.empty()) {
+            size_t depth = dfsStack.size() - 1;
+            Id indexVertex = dfsStack[depth].vertex;
+            Id parent = depth > 0 ? dfsStack[depth-1].vertex : NONE;
+            // The parent frame already moved past the tree edge to this vertex
+            Id parentEdge = depth > 0 ? graph.edges[dfsStack[depth-1].next - 1] : NONE;
+
+            if (dfsStack[depth].next == graph.offsets[indexVertex+1]) {
+                // All adjacent vertices were visited: return to the parent
+                dfsStack.pop_back();
+                if (depth > 0) {
+                    Id grandParent = depth > 1 ? dfsStack[depth-2].vertex : NONE;
+                    finishChild(graph, parent, grandParent, indexVertex, dfsStack[depth-1].next - 1, children);
+                }
+                continue;
+            }
+
+            Id position = dfsStack[depth].next++;
+            Id adjacente = graph.targets[position];
+            if(vertices[adjacente].discoveryTime == 0) {
+                if (parent == NONE) children++;
+                if (labelEdges) {
+                    edgeStack.push_back({indexVertex, position});
+                    pushed++;
+                }
+
+                Id childTime = vertices[indexVertex].discoveryTime + 1;
+                vertices[adjacente].updateDiscoveryTime(childTime);
+                vertices[adjacente].updateLowLink(childTime);
+                dfsStack.push_back({adjacente, graph.offsets[adjacente]});
+                if (buildBridges) componentStack.push_back(adjacente);
+                if (!labelEdges) vertexStack.push_back(adjacente);
+
+            } else if(graph.edges[position] != parentEdge) {
+                // Only the tree edge is skipped, so parallel edges to the parent are labeled too
+                if(vertices[adjacente].discoveryTime < vertices[indexVertex].lowLink) {
+                    vertices[indexVertex].updateLowLink(vertices[adjacente].discoveryTime);
+                }
+                if(labelEdges && vertices[adjacente].discoveryTime < vertices[indexVertex].discoveryTime) {
+                    edgeStack.push_back({indexVertex, position});
+                    pushed++;
+                }
+            }
+        }
+
+        if(children > 1) {
+            addLink(root);
+        }
+        if (buildBridges) {
+            findEdgeComponent(root);
+        }
+        counters.edgesPushed += pushed;
+    }
+
+    // Root of the set containing vertex in a union-find shared by all threads, halving the
+    // path on the way. Sets are always linked from the larger root to the smaller one, so the
+    // root of a set is its smallest element.
+    static Id findSet(AtomicArray &sets, Id vertex) {
+        for (;;) {
+            Id parent = sets[vertex].load();
+            Id grandParent = sets[parent].load();
+            if (parent == grandParent) return parent;
+            sets[vertex].compare_exchange_weak(parent, grandParent);
+            vertex = grandParent;
+        }
+    }
+
+    static void uniteSets(AtomicArray &sets, Id a, Id b) {
+        for (;;) {
+            a = findSet(sets, a);
+            b = findSet(sets, b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            Id expected = a;
+            if (sets[a].compare_exchange_strong(expected, b)) return;
+        }
+    }
+
+    // Finds the articulation points and clusters with the Tarjan-Vishkin algorithm, running
+    // every step as a parallel loop on the pool, and fills the same structures as the DFS
+    // (isLink, the cluster arena and blockOf). Steps:
+    //  1. connected components, rooting each spanning tree at the smallest vertex;
+    //  2. a spanning forest by BFS from all roots at once, one level at a time;
+    //  3. subtree sizes bottom-up and preorder numbers top-down over the BFS levels;
+    //  4. low/high: the smallest and largest preorder number adjacent to each subtree;
+    //  5. connectivity of the auxiliary graph whose vertices are the tree edges (each named by
+    //     its lower endpoint): two tree edges are in the same cluster when a non-tree edge joins
+    //     two unrelated vertices below them, or when the subtree below the lower edge reaches
+    //     outside the subtree below the upper one. Its components are the clusters.
+    void parallelClusters(const Graph &graph, Id nVertexs, ThreadPool &pool) {
+        Id n = nVertexs;
+        int nWorkers = pool.size();
+        AtomicArray sets(n);
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) sets[v].store((Id)v);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t u = begin; u < end; u++) {
+                for (Id k = graph.offsets[u]; k < graph.offsets[u+1]; k++) {
+                    uniteSets(sets, (Id)u, graph.targets[k]);
+                }
+            }
+        }, 64);
+
+        // BFS forest: bfsOrder lists the vertices level by level, level l being bfsOrder[levelStart[l]..levelStart[l+1])
+        AtomicArray bfsParent(n);
+        std::vector<Id> bfsOrder;
+        bfsOrder.reserve(n);
+        std::vector<size_t> levelStart(1, 0);
+        std::vector<std::vector<Id>> found(nWorkers);
+        auto appendFound = [&]() {
+            for (std::vector<Id> &vertexs : found) {
+                bfsOrder.insert(bfsOrder.end(), vertexs.begin(), vertexs.end());
+                vertexs.clear();
+            }
+            levelStart.push_back(bfsOrder.size());
+        };
+
+        pool.parallelFor(n, [&](size_t begin, size_t end, int worker) {
+            for (size_t v = begin; v < end; v++) {
+                bool root = findSet(sets, (Id)v) == v;
+                bfsParent[v].store(root ? (Id)v : NONE);
+                if (root) found[worker].push_back((Id)v);
+            }
+        });
+        appendFound();
+
+        while (levelStart.back() > levelStart[levelStart.size()-2]) {
+            size_t first = levelStart[levelStart.size()-2];
+            pool.parallelFor(levelStart.back() - first, [&](size_t begin, size_t end, int worker) {
+                for (size_t i = first + begin; i < first + end; i++) {
+                    Id u = bfsOrder[i];
+                    for (Id k = graph.offsets[u]; k < graph.offsets[u+1]; k++) {
+                        Id w = graph.targets[k];
+                        Id expected = NONE;
+                        if (bfsParent[w].load() == NONE && bfsParent[w].compare_exchange_strong(expected, u)) {
+                            found[worker].push_back(w);
+                        }
+                    }
+                }
+            }, 64);
+            appendFound();
+        }
+        levelStart.pop_back(); // The last level is empty
+        int nLevels = (int)levelStart.size() - 1;
+
+        // Children of each vertex, in compressed sparse row form
+        std::vector<Id> parentOf(n);
+        AtomicArray childCount(n + 1);
+        pool.parallelFor(n + 1, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) childCount[v].store(0);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                parentOf[v] = bfsParent[v].load();
+                if (parentOf[v] != v) childCount[parentOf[v]+1].fetch_add(1);
+            }
+        });
+        std::vector<Id> childOffsets(n + 1, 0);
+        for (Id v = 1; v <= n; v++) {
+            childOffsets[v] = childOffsets[v-1] + childCount[v].load();
+        }
+        std::vector<Id> children(childOffsets[n]);
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) childCount[v].store(0);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                if (parentOf[v] != v) children[childOffsets[parentOf[v]] + childCount[parentOf[v]].fetch_add(1)] = (Id)v;
+            }
+        });
+
+        // Runs body(v) for every vertex of each level, from the deepest level up or from the roots down
+        auto forEachLevel = [&](bool bottomUp, auto body) {
+            for (int step = 0; step < nLevels; step++) {
+                int level = bottomUp ? nLevels - 1 - step : step;
+                size_t first = levelStart[level];
+                pool.parallelFor(levelStart[level+1] - first, [&](size_t begin, size_t end, int) {
+                    for (size_t i = first + begin; i < first + end; i++) body(bfsOrder[i]);
+                }, 256);
+            }
+        };
+
+        std::vector<Id> subtreeSize(n), preorder(n), low(n), high(n);
+        forEachLevel(true, [&](Id v) {
+            Id size = 1;
+            for (Id k = childOffsets[v]; k < childOffsets[v+1]; k++) size += subtreeSize[children[k]];
+            subtreeSize[v] = size;
+        });
+
+        Id nextPreorder = 0;
+        for (size_t i = levelStart[0]; i < levelStart[1]; i++) {
+            preorder[bfsOrder[i]] = nextPreorder;
+            nextPreorder += subtreeSize[bfsOrder[i]];
+        }
+        forEachLevel(false, [&](Id v) {
+            Id next = preorder[v] + 1;
+            for (Id k = childOffsets[v]; k < childOffsets[v+1]; k++) {
+                preorder[children[k]] = next;
+                next += subtreeSize[children[k]];
+            }
+        });
+
+        // Every adjacent preorder number may be used, tree edges included: they never leave the
+        // subtree of the parent, so they cannot join two clusters
+        forEachLevel(true, [&](Id v) {
+            Id lowest = preorder[v], highest = preorder[v];
+            for (Id k = graph.offsets[v]; k < graph.offsets[v+1]; k++) {
+                lowest = std::min(lowest, preorder[graph.targets[k]]);
+                highest = std::max(highest, preorder[graph.targets[k]]);
+            }
+            for (Id k = childOffsets[v]; k < childOffsets[v+1]; k++) {
+                lowest = std::min(lowest, low[children[k]]);
+                highest = std::max(highest, high[children[k]]);
+            }
+            low[v] = lowest;
+            high[v] = highest;
+        });
+
+        // Auxiliary graph: sets of tree edges, each one named by its lower endpoint
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) sets[v].store((Id)v);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t u = begin; u < end; u++) {
+                for (Id k = graph.offsets[u]; k < graph.offsets[u+1]; k++) {
+                    Id w = graph.targets[k];
+                    // Non-tree edge between unrelated vertices, seen from the one visited first
+                    if (preorder[u] < preorder[w] && preorder[w] >= preorder[u] + subtreeSize[u]) {
+                        uniteSets(sets, (Id)u, w);
+                    }
+                }
+
+                Id v = parentOf[u];
+                if (v != u && parentOf[v] != v &&
+                    (low[u] < preorder[v] || high[u] >= preorder[v] + subtreeSize[v])) {
+                    uniteSets(sets, v, (Id)u);
+                }
+            }
+        }, 64);
+
+        // Number the clusters by their smallest tree edge; each cluster has the lower endpoints
+        // of its tree edges plus one top vertex, the upper endpoint of its highest tree edge
+        std::vector<Id> clusterOf(n, NONE);
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                if (parentOf[v] != v) clusterOf[v] = findSet(sets, (Id)v);
+            }
+        });
+        std::vector<Id> clusterIndex(n, NONE);
+        nClusters = 0;
+        for (Id v = 0; v < n; v++) {
+            if (clusterOf[v] == v) clusterIndex[v] = nClusters++;
+        }
+
+        std::vector<Id> top(nClusters);
+        AtomicArray clusterSize(nClusters + 1), linkCount(n);
+        pool.parallelFor(nClusters + 1, [&](size_t begin, size_t end, int) {
+            for (size_t c = begin; c < end; c++) clusterSize[c].store(0);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) linkCount[v].store(parentOf[v] != v ? 1 : 0);
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                if (parentOf[v] == v) continue;
+                Id c = clusterIndex[clusterOf[v]];
+                Id p = parentOf[v];
+                clusterSize[c+1].fetch_add(1);
+                if (parentOf[p] == p || clusterOf[p] != clusterOf[v]) {
+                    top[c] = p; // Every tree edge of the cluster hanging from outside it has the same top
+                }
+            }
+        });
+        pool.parallelFor(nClusters, [&](size_t begin, size_t end, int) {
+            for (size_t c = begin; c < end; c++) linkCount[top[c]].fetch_add(1);
+        });
+
+        clusterOffsets.assign(nClusters + 1, 0);
+        for (Id c = 0; c < nClusters; c++) {
+            clusterOffsets[c+1] = clusterOffsets[c] + clusterSize[c+1].load() + 1;
+        }
+        clusterMembers.resize(clusterOffsets[nClusters]);
+        pool.parallelFor(nClusters, [&](size_t begin, size_t end, int) {
+            for (size_t c = begin; c < end; c++) {
+                clusterSize[c].store(0);
+                clusterMembers[clusterOffsets[c+1] - 1] = top[c] + 1;
+            }
+        });
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                if (parentOf[v] == v) continue;
+                Id c = clusterIndex[clusterOf[v]];
+                clusterMembers[clusterOffsets[c] + clusterSize[c].fetch_add(1)] = (Id)v + 1;
+            }
+        });
+        pool.parallelFor(nClusters, [&](size_t begin, size_t end, int) {
+            for (size_t c = begin; c < end; c++) {
+                std::sort(clusterMembers.begin() + clusterOffsets[c], clusterMembers.begin() + clusterOffsets[c+1]);
+            }
+        }, 64);
+
+        // A vertex is a link when it belongs to two or more clusters
+        nLinks = 0;
+        for (Id v = 0; v < n; v++) {
+            if (linkCount[v].load() >= 2) addLink(v);
+        }
+
+        // Each edge belongs to the cluster of the tree edge above its endpoint visited last
+        pool.parallelFor(n, [&](size_t begin, size_t end, int) {
+            for (size_t u = begin; u < end; u++) {
+                for (Id k = graph.offsets[u]; k < graph.offsets[u+1]; k++) {
+                    if (preorder[u] > preorder[graph.targets[k]]) {
+                        blockOf[graph.edges[k]] = clusterIndex[clusterOf[u]] + 1;
+                    }
+                }
+            }
+        }, 64);
+
+        for (Id c = 0; c < nClusters; c++) {
+            visitor.block(c + 1, clusterMembers.data() + clusterOffsets[c], (size_t)(clusterOffsets[c+1] - clusterOffsets[c]));
+        }
+        counters.clusters += nClusters;
+    }
+};
+
+#endif
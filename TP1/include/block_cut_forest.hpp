@@ -0,0 +1,298 @@
+#ifndef BLOCK_CUT_FOREST_HPP
+#define BLOCK_CUT_FOREST_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Block-cut forest kept up to date while edges are inserted. Each tree has a node for every
+// vertex and for every cluster (block), with an edge between a vertex and each cluster that
+// contains it, stored as parent pointers. Vertices are nodes 0..n-1 and cluster c is node n+c.
+//
+// An edge between two trees creates a cluster with its two endpoints, after the smaller tree
+// is rerooted at its endpoint. An edge inside a tree merges every cluster on the tree path
+// between its endpoints; merged clusters are kept in a union-find, so nodes that still point
+// to a merged cluster are redirected on the way. The path is found by climbing from both
+// endpoints at once, so an insertion costs about the number of clusters it merges. Only the
+// ids of the merged clusters are reported, never their vertices, so the output of an
+// insertion is as small as its work.
+class BlockCutForest {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // What the last insertion changed: a cluster was created with the two endpoints of the
+    // edge, clusters were merged into one (merged has the ids of the others), or nothing.
+    struct Change {
+        enum Kind { NONE, CREATED, MERGED } kind;
+        uint32_t cluster;
+        uint32_t u, v;
+        std::vector<uint32_t> merged;
+        std::vector<uint32_t> newLinks;
+        std::vector<uint32_t> removedLinks;
+    };
+
+    // Builds the forest from the cluster arena; cluster order[i] gets the id nVertexs+i+1, as
+    // in the output. Members are 1-based vertices.
+    BlockCutForest(int nVertexs, const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &members,
+                   const std::vector<uint32_t> &order)
+        : n(nVertexs), nLinks(0), nextId(nVertexs + (uint32_t)order.size() + 1), stamp(0) {
+        uint32_t nClusters = (uint32_t)order.size();
+        parent.assign(n + nClusters, NONE);
+        clusterSet.resize(nClusters);
+        clusterId.resize(nClusters);
+        setSize.assign(nClusters, 1);
+        blockCount.assign(n, 0);
+        component.resize(n);
+        componentSize.assign(n, 1);
+        mark.assign(n + nClusters, 0);
+
+        // Clusters containing each vertex, in compressed sparse row form
+        std::vector<uint32_t> incidenceOffsets(n + 1, 0);
+        for (uint32_t c = 0; c < nClusters; c++) {
+            clusterSet[c] = c;
+            clusterId[c] = n + c + 1;
+            for (uint32_t k = offsets[order[c]]; k < offsets[order[c]+1]; k++) {
+                incidenceOffsets[members[k]]++;
+            }
+        }
+        for (uint32_t v = 0; v < n; v++) {
+            blockCount[v] = incidenceOffsets[v+1];
+            if (blockCount[v] >= 2) nLinks++;
+            incidenceOffsets[v+1] += incidenceOffsets[v];
+        }
+        std::vector<uint32_t> incidences(incidenceOffsets[n]);
+        std::vector<uint32_t> position(incidenceOffsets.begin(), incidenceOffsets.end() - 1);
+        for (uint32_t c = 0; c < nClusters; c++) {
+            for (uint32_t k = offsets[order[c]]; k < offsets[order[c]+1]; k++) {
+                incidences[position[members[k] - 1]++] = c;
+            }
+        }
+
+        // Root every tree at its smallest vertex with a BFS over vertices and clusters
+        std::vector<char> visited(n + nClusters, 0);
+        std::vector<uint32_t> queue;
+        for (uint32_t root = 0; root < n; root++) {
+            if (visited[root]) continue;
+            visited[root] = 1;
+            component[root] = root;
+            queue.assign(1, root);
+            for (size_t head = 0; head < queue.size(); head++) {
+                uint32_t vertex = queue[head];
+                for (uint32_t k = incidenceOffsets[vertex]; k < incidenceOffsets[vertex+1]; k++) {
+                    uint32_t c = incidences[k];
+                    if (visited[n + c]) continue;
+                    visited[n + c] = 1;
+                    parent[n + c] = vertex;
+                    for (uint32_t k = offsets[order[c]]; k < offsets[order[c]+1]; k++) {
+                        uint32_t member = members[k] - 1;
+                        if (visited[member]) continue;
+                        visited[member] = 1;
+                        parent[member] = n + c;
+                        component[member] = root;
+                        componentSize[root]++;
+                        queue.push_back(member);
+                    }
+                }
+            }
+        }
+        nLive = nClusters;
+    }
+
+    uint32_t links() const {
+        return nLinks;
+    }
+
+    uint32_t clusters() const {
+        return nLive;
+    }
+
+    const Change &lastChange() const {
+        return change;
+    }
+
+    uint32_t id(uint32_t cluster) const {
+        return clusterId[cluster];
+    }
+
+    // Inserts the edge between the 0-based vertices u and v
+    void addEdge(uint32_t u, uint32_t v) {
+        change.kind = Change::NONE;
+        change.u = u;
+        change.v = v;
+        change.merged.clear();
+        change.newLinks.clear();
+        change.removedLinks.clear();
+        if (u == v) return;
+
+        uint32_t componentU = findComponent(u), componentV = findComponent(v);
+        if (componentU != componentV) {
+            linkTrees(u, v, componentU, componentV);
+        } else {
+            mergePath(u, v);
+        }
+    }
+
+private:
+    uint32_t n;
+    uint32_t nLinks;
+    uint32_t nLive;
+    uint32_t nextId;
+    uint32_t stamp;
+    std::vector<uint32_t> parent;          // Parent node of every node, NONE at the roots
+    std::vector<uint32_t> clusterSet;      // Union-find of merged clusters
+    std::vector<uint32_t> setSize;         // Number of clusters merged into each set
+    std::vector<uint32_t> clusterId;       // Printed id of each surviving cluster
+    std::vector<uint32_t> blockCount;      // Number of clusters containing each vertex
+    std::vector<uint32_t> component;       // Union-find of the trees, over vertices
+    std::vector<uint32_t> componentSize;
+    std::vector<uint32_t> mark;            // Path search marks: 2*stamp for the side of u, 2*stamp+1 for v
+    std::vector<uint32_t> pathU, pathV, path;
+    Change change;
+
+    uint32_t findCluster(uint32_t c) {
+        while (clusterSet[c] != c) {
+            clusterSet[c] = clusterSet[clusterSet[c]];
+            c = clusterSet[c];
+        }
+        return c;
+    }
+
+    uint32_t findComponent(uint32_t v) {
+        while (component[v] != v) {
+            component[v] = component[component[v]];
+            v = component[v];
+        }
+        return v;
+    }
+
+    // Parent of a node, following merged clusters
+    uint32_t up(uint32_t node) {
+        uint32_t next = parent[node];
+        if (node < n && next != NONE) return n + findCluster(next - n);
+        return next;
+    }
+
+    uint32_t newCluster() {
+        uint32_t c = (uint32_t)clusterSet.size();
+        clusterSet.push_back(c);
+        setSize.push_back(1);
+        clusterId.push_back(nextId++);
+        parent.push_back(NONE);
+        mark.push_back(0);
+        nLive++;
+        return c;
+    }
+
+    void addBlock(uint32_t vertex) {
+        if (++blockCount[vertex] == 2) {
+            nLinks++;
+            change.newLinks.push_back(vertex);
+        }
+    }
+
+    // Joins the trees of u and v with a new cluster {u, v}
+    void linkTrees(uint32_t u, uint32_t v, uint32_t componentU, uint32_t componentV) {
+        if (componentSize[componentU] > componentSize[componentV]) {
+            std::swap(u, v);
+            std::swap(componentU, componentV);
+        }
+
+        // Reroot the smaller tree at u by reversing the parent pointers above it
+        uint32_t previous = NONE;
+        for (uint32_t node = u; node != NONE;) {
+            uint32_t next = up(node);
+            parent[node] = previous;
+            previous = node;
+            node = next;
+        }
+
+        uint32_t c = newCluster();
+        parent[n + c] = v;
+        parent[u] = n + c;
+        addBlock(u);
+        addBlock(v);
+        component[componentU] = componentV;
+        componentSize[componentV] += componentSize[componentU];
+        change.kind = Change::CREATED;
+        change.cluster = c;
+    }
+
+    // Merges the clusters on the tree path between u and v
+    void mergePath(uint32_t u, uint32_t v) {
+        stamp++;
+        pathU.assign(1, u);
+        pathV.assign(1, v);
+        mark[u] = 2 * stamp;
+        mark[v] = 2 * stamp + 1;
+
+        // Climb from both ends, one step each, until one side reaches a node of the other
+        uint32_t meeting = NONE;
+        bool sideUDone = false, sideVDone = false;
+        while (meeting == NONE) {
+            if (sideUDone && sideVDone) return; // Not in the same tree; cannot happen after findComponent
+            for (int side = 0; side < 2 && meeting == NONE; side++) {
+                std::vector<uint32_t> &own = side == 0 ? pathU : pathV;
+                bool &done = side == 0 ? sideUDone : sideVDone;
+                if (done) continue;
+                uint32_t next = up(own.back());
+                if (next == NONE) {
+                    done = true;
+                } else if (mark[next] == 2 * stamp + (1 - side)) {
+                    meeting = next;
+                    std::vector<uint32_t> &other = side == 0 ? pathV : pathU;
+                    while (other.back() != next) other.pop_back();
+                    other.pop_back();
+                } else {
+                    mark[next] = 2 * stamp + side;
+                    own.push_back(next);
+                }
+            }
+        }
+        path = pathU;
+        path.push_back(meeting);
+        path.insert(path.end(), pathV.rbegin(), pathV.rend());
+
+        uint32_t nPathClusters = 0, base = NONE;
+        for (uint32_t node : path) {
+            if (node < n) continue;
+            nPathClusters++;
+            uint32_t c = node - n;
+            if (base == NONE || setSize[c] > setSize[base]) base = c;
+        }
+        if (nPathClusters == 1) return; // The edge is inside an existing cluster
+
+        uint32_t newParent = meeting < n ? meeting : parent[meeting];
+
+        // Vertices inside the path now belong to one cluster instead of two
+        for (size_t i = 1; i + 1 < path.size(); i++) {
+            uint32_t vertex = path[i];
+            if (vertex < n && --blockCount[vertex] == 1) {
+                nLinks--;
+                change.removedLinks.push_back(vertex);
+            }
+        }
+
+        // The merged cluster keeps the smallest id among the path clusters
+        uint32_t survivorId = clusterId[base];
+        for (uint32_t node : path) {
+            if (node >= n) survivorId = std::min(survivorId, clusterId[node - n]);
+        }
+        for (uint32_t node : path) {
+            if (node < n) continue;
+            uint32_t c = node - n;
+            if (clusterId[c] != survivorId) change.merged.push_back(clusterId[c]);
+            if (c != base) {
+                clusterSet[c] = base;
+                setSize[base] += setSize[c];
+                nLive--;
+            }
+        }
+        clusterId[base] = survivorId;
+        parent[n + base] = newParent;
+        change.kind = Change::MERGED;
+        change.cluster = base;
+    }
+};
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef BLOCK_CUT_INDEX_HPP
+#define BLOCK_CUT_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Static block-cut forest with an LCA index, answering separation queries in constant time.
+// As in BlockCutForest, the forest has a node for every vertex (0..n-1) and for every
+// cluster (n+c), with an edge between a vertex and each cluster that contains it. A vertex
+// separates u from v exactly when it is an inner node of the tree path between them, and
+// the cut vertices between u and v are the vertex nodes inside that path.
+//
+// The LCA of two nodes a, b with preorder[a] < preorder[b] is the parent of the shallowest
+// node whose preorder lies in (preorder[a], preorder[b]]. That range minimum is answered in
+// O(1) with blocks of 64 positions: a sparse table over the minimum of each block, and for
+// every position a bit mask of the increasing stack of minima from the start of its block.
+class BlockCutIndex {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Builds the index from the cluster arena; members are 1-based vertices
+    BlockCutIndex(int nVertexs, const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &members)
+        : n(nVertexs) {
+        uint32_t nClusters = (uint32_t)offsets.size() - 1;
+        uint32_t nNodes = n + nClusters;
+
+        // Clusters containing each vertex, in compressed sparse row form
+        std::vector<uint32_t> incidenceOffsets(n + 1, 0);
+        for (uint32_t member : members) {
+            incidenceOffsets[member]++;
+        }
+        for (uint32_t v = 0; v < n; v++) {
+            incidenceOffsets[v+1] += incidenceOffsets[v];
+        }
+        std::vector<uint32_t> incidences(members.size());
+        std::vector<uint32_t> position(incidenceOffsets.begin(), incidenceOffsets.end() - 1);
+        for (uint32_t c = 0; c < nClusters; c++) {
+            for (uint32_t k = offsets[c]; k < offsets[c+1]; k++) {
+                incidences[position[members[k] - 1]++] = c;
+            }
+        }
+
+        // Preorder DFS from the smallest vertex of every tree, with an explicit stack of
+        // (node, next neighbour) pairs
+        parent.assign(nNodes, NONE);
+        preorder.assign(nNodes, 0);
+        subtreeEnd.assign(nNodes, 0);
+        depth.assign(nNodes, 0);
+        component.assign(nNodes, 0);
+        nodeAt.resize(nNodes);
+        std::vector<char> visited(nNodes, 0);
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        uint32_t next = 0;
+        for (uint32_t root = 0; root < n; root++) {
+            if (visited[root]) continue;
+            visited[root] = 1;
+            enter(root, NONE, root, next);
+            stack.push_back({root, 0});
+            while (!stack.empty()) {
+                uint32_t node = stack.back().first;
+                uint32_t &k = stack.back().second;
+                uint32_t child = NONE;
+                if (node < n) {
+                    while (child == NONE && incidenceOffsets[node] + k < incidenceOffsets[node+1]) {
+                        uint32_t c = n + incidences[incidenceOffsets[node] + k++];
+                        if (!visited[c]) child = c;
+                    }
+                } else {
+                    uint32_t c = node - n;
+                    while (child == NONE && offsets[c] + k < offsets[c+1]) {
+                        uint32_t member = members[offsets[c] + k++] - 1;
+                        if (!visited[member]) child = member;
+                    }
+                }
+                if (child == NONE) {
+                    subtreeEnd[node] = next;
+                    stack.pop_back();
+                    continue;
+                }
+                visited[child] = 1;
+                enter(child, node, root, next);
+                stack.push_back({child, 0});
+            }
+        }
+        buildRangeMinimum();
+    }
+
+    bool connected(uint32_t u, uint32_t v) const {
+        return component[u] == component[v];
+    }
+
+    // Whether removing the vertex x disconnects the vertices u and v (0-based). Vertices that
+    // are already disconnected, and u or v themselves, are never reported as separating.
+    bool separates(uint32_t x, uint32_t u, uint32_t v) const {
+        if (x == u || x == v || !connected(u, v) || !connected(x, u)) return false;
+        uint32_t ancestor = lca(u, v);
+        return isAncestor(ancestor, x) && (isAncestor(x, u) || isAncestor(x, v));
+    }
+
+    // Appends the cut vertices between the connected vertices u and v to out, in the order
+    // they appear on the way from u to v
+    void listBetween(uint32_t u, uint32_t v, std::vector<uint32_t> &out) const {
+        if (u == v) return;
+        uint32_t ancestor = lca(u, v);
+        for (uint32_t node = u; node != ancestor; node = parent[node]) {
+            if (node < n && node != u) out.push_back(node);
+        }
+        if (ancestor < n && ancestor != u && ancestor != v) out.push_back(ancestor);
+        size_t middle = out.size();
+        for (uint32_t node = v; node != ancestor; node = parent[node]) {
+            if (node < n && node != v) out.push_back(node);
+        }
+        std::reverse(out.begin() + middle, out.end());
+    }
+
+private:
+    static const uint32_t BLOCK = 64;
+
+    uint32_t n;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> preorder;
+    std::vector<uint32_t> subtreeEnd;      // Preorder number after the last node of the subtree
+    std::vector<uint32_t> depth;
+    std::vector<uint32_t> component;       // Root of the tree of each node
+    std::vector<uint32_t> nodeAt;          // Node with each preorder number
+    std::vector<uint32_t> depthAt;         // Depth of the node with each preorder number
+    std::vector<uint64_t> stackMask;       // Minima stack inside the block, ending at each position
+    std::vector<std::vector<uint32_t>> blockTable; // blockTable[k][b]: position of the minimum of blocks b .. b+2^k-1
+
+    void enter(uint32_t node, uint32_t from, uint32_t root, uint32_t &next) {
+        parent[node] = from;
+        depth[node] = from == NONE ? 0 : depth[from] + 1;
+        component[node] = root;
+        preorder[node] = next;
+        nodeAt[next++] = node;
+    }
+
+    bool isAncestor(uint32_t a, uint32_t b) const {
+        return preorder[a] <= preorder[b] && preorder[b] < subtreeEnd[a];
+    }
+
+    uint32_t lower(uint32_t a, uint32_t b) const {
+        return depthAt[b] < depthAt[a] ? b : a;
+    }
+
+    void buildRangeMinimum() {
+        uint32_t size = (uint32_t)nodeAt.size();
+        depthAt.resize(size);
+        stackMask.resize(size);
+        for (uint32_t i = 0; i < size; i++) {
+            depthAt[i] = depth[nodeAt[i]];
+        }
+
+        uint32_t nBlocks = (size + BLOCK - 1) / BLOCK;
+        blockTable.assign(1, std::vector<uint32_t>(nBlocks));
+        for (uint32_t b = 0; b < nBlocks; b++) {
+            uint32_t start = b * BLOCK, end = std::min(size, start + BLOCK);
+            uint64_t mask = 0;
+            uint32_t best = start;
+            for (uint32_t i = start; i < end; i++) {
+                while (mask != 0 && depthAt[start + 63 - __builtin_clzll(mask)] > depthAt[i]) {
+                    mask &= ~(1ULL << (63 - __builtin_clzll(mask)));
+                }
+                mask |= 1ULL << (i - start);
+                stackMask[i] = mask;
+                best = lower(best, i);
+            }
+            blockTable[0][b] = best;
+        }
+        for (uint32_t k = 1; (1u << k) <= nBlocks; k++) {
+            const std::vector<uint32_t> &previous = blockTable[k-1];
+            std::vector<uint32_t> level(nBlocks - (1u << k) + 1);
+            for (uint32_t b = 0; b < level.size(); b++) {
+                level[b] = lower(previous[b], previous[b + (1u << (k-1))]);
+            }
+            blockTable.push_back(std::move(level));
+        }
+    }
+
+    // Position of a shallowest node in [left, right] when both are in the same block
+    uint32_t minimumInBlock(uint32_t left, uint32_t right) const {
+        uint32_t start = left - left % BLOCK;
+        return start + __builtin_ctzll(stackMask[right] & (~0ULL << (left - start)));
+    }
+
+    uint32_t minimum(uint32_t left, uint32_t right) const {
+        uint32_t blockLeft = left / BLOCK, blockRight = right / BLOCK;
+        if (blockLeft == blockRight) return minimumInBlock(left, right);
+        uint32_t best = lower(minimumInBlock(left, blockLeft * BLOCK + BLOCK - 1), minimumInBlock(blockRight * BLOCK, right));
+        if (blockLeft + 1 < blockRight) {
+            uint32_t k = 31 - __builtin_clz(blockRight - blockLeft - 1);
+            best = lower(best, lower(blockTable[k][blockLeft + 1], blockTable[k][blockRight - (1u << k)]));
+        }
+        return best;
+    }
+
+    uint32_t lca(uint32_t a, uint32_t b) const {
+        if (a == b) return a;
+        uint32_t left = preorder[a], right = preorder[b];
+        if (left > right) std::swap(left, right);
+        return parent[nodeAt[minimum(left + 1, right)]];
+    }
+};
+
+#endif
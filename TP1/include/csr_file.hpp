@@ -0,0 +1,178 @@
+#ifndef CSR_FILE_HPP
+#define CSR_FILE_HPP
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary file with a graph in compressed sparse row form, loaded by mapping it read-only, so
+// a run starts without parsing and concurrent runs on the same file share the page cache.
+// Layout (native byte order, which the magic number also checks):
+//   CSRFileHeader
+//   offsets: nVertexs + 1 uint32_t
+//   targets: 2 * nEdges uint32_t, the adjacent vertices (0-based) of every vertex
+//   edges:   2 * nEdges uint32_t, the index in the input of the edge at each position
+// The checksum covers the counts and the offsets. Loading also checks that the offsets never
+// decrease and that every target is a vertex and every edge index an edge, so the DFS can index
+// by them without bounds checks.
+struct CSRFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t nVertexs;
+    uint64_t nEdges;
+    uint64_t checksum;
+};
+
+static const char CSR_MAGIC[8] = {'A', 'L', 'G', '1', 'C', 'S', 'R', '\0'};
+const uint32_t CSR_VERSION = 1;
+const uint32_t CSR_HAS_CHECKSUM = 1;
+
+// FNV-1a over the counts and the offsets
+inline uint64_t csrChecksum(uint64_t nVertexs, uint64_t nEdges, const uint32_t *offsets) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t word) {
+        hash = (hash ^ word) * 1099511628211ULL;
+    };
+    mix(nVertexs);
+    mix(nEdges);
+    for (uint64_t v = 0; v <= nVertexs; v++) {
+        mix(offsets[v]);
+    }
+    return hash;
+}
+
+inline CSRFileHeader csrHeader(uint32_t nVertexs, uint32_t nEdges, const uint32_t *offsets) {
+    CSRFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CSR_MAGIC, sizeof(CSR_MAGIC));
+    header.version = CSR_VERSION;
+    header.flags = CSR_HAS_CHECKSUM;
+    header.nVertexs = nVertexs;
+    header.nEdges = nEdges;
+    header.checksum = csrChecksum(nVertexs, nEdges, offsets);
+    return header;
+}
+
+inline bool writeCSRFile(const char *path, uint32_t nVertexs, uint32_t nEdges,
+                         const uint32_t *offsets, const uint32_t *targets, const uint32_t *edges) {
+    CSRFileHeader header = csrHeader(nVertexs, nEdges, offsets);
+
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "Error creating %s\n", path);
+        return false;
+    }
+    size_t nPositions = 2 * (size_t)nEdges;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(offsets, sizeof(uint32_t), (size_t)nVertexs + 1, file) == (size_t)nVertexs + 1 &&
+                   fwrite(targets, sizeof(uint32_t), nPositions, file) == nPositions &&
+                   fwrite(edges, sizeof(uint32_t), nPositions, file) == nPositions;
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "Error writing %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Read-only mapping of a graph file. The arrays stay valid while the object lives.
+class CSRFile {
+public:
+    CSRFile() : data(nullptr), size(0), header(nullptr) {}
+
+    ~CSRFile() {
+        if (data != nullptr) munmap(data, size);
+    }
+
+    bool open(const char *path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            fprintf(stderr, "Error opening %s\n", path);
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CSRFileHeader)) {
+            fprintf(stderr, "%s is not a graph file\n", path);
+            close(fd);
+            return false;
+        }
+        size = info.st_size;
+        void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "Error mapping %s\n", path);
+            return false;
+        }
+        data = map;
+        madvise(data, size, MADV_WILLNEED);
+
+        header = (const CSRFileHeader *)data;
+        if (memcmp(header->magic, CSR_MAGIC, sizeof(CSR_MAGIC)) != 0 || header->version != CSR_VERSION) {
+            fprintf(stderr, "%s is not a graph file of version %u\n", path, CSR_VERSION);
+            return false;
+        }
+        if (header->nVertexs > INT_MAX || header->nEdges > UINT32_MAX / 2 ||
+            size != sizeof(CSRFileHeader) + sizeof(uint32_t) * (header->nVertexs + 1 + 4 * header->nEdges)) {
+            fprintf(stderr, "%s has the wrong size for its counts\n", path);
+            return false;
+        }
+        if (offsets()[0] != 0 || offsets()[header->nVertexs] != 2 * header->nEdges ||
+            ((header->flags & CSR_HAS_CHECKSUM) &&
+             csrChecksum(header->nVertexs, header->nEdges, offsets()) != header->checksum) ||
+            !inBounds()) {
+            fprintf(stderr, "%s is corrupted\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    int vertexCount() const {
+        return (int)header->nVertexs;
+    }
+
+    int edgeCount() const {
+        return (int)header->nEdges;
+    }
+
+    const uint32_t *offsets() const {
+        return (const uint32_t *)(header + 1);
+    }
+
+    const uint32_t *targets() const {
+        return offsets() + header->nVertexs + 1;
+    }
+
+    const uint32_t *edges() const {
+        return targets() + 2 * header->nEdges;
+    }
+
+    size_t bytes() const {
+        return size;
+    }
+
+private:
+    // Offsets non-decreasing, targets below nVertexs and edge indices below nEdges
+    bool inBounds() const {
+        const uint32_t *offset = offsets();
+        for (uint64_t v = 0; v < header->nVertexs; v++) {
+            if (offset[v] > offset[v + 1]) return false;
+        }
+        const uint32_t *target = targets();
+        const uint32_t *edge = edges();
+        for (uint64_t i = 0; i < 2 * header->nEdges; i++) {
+            if (target[i] >= header->nVertexs || edge[i] >= header->nEdges) return false;
+        }
+        return true;
+    }
+
+    void *data;
+    size_t size;
+    const CSRFileHeader *header;
+};
+
+#endif
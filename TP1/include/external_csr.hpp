@@ -0,0 +1,322 @@
+#ifndef EXTERNAL_CSR_HPP
+#define EXTERNAL_CSR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <queue>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "csr_file.hpp"
+
+// Builds a graph file (see csr_file.hpp) from an edge list that may not fit in memory, with an
+// external sort by source vertex. Only the degrees (O(nVertexs)) and the buffers fit in the
+// memory budget:
+//  1. the edges are read a chunk at a time; both directions of each edge are sorted in memory
+//     and appended as a run to one temporary file;
+//  2. while there are more than EXTERNAL_MERGE_FAN_IN runs, groups of that many are merged into
+//     longer runs of a new temporary file, one pass over the data each time;
+//  3. the last runs are merged with a heap, each read through its own slice of the budget, and
+//     the targets and edge indexes are streamed to their regions of the graph file.
+// All the runs of a pass share one file, so the number of open files does not grow with the
+// number of runs.
+// Entries are ordered by source and then by input edge index, the order buildCSR produces, so
+// the DFS over the file visits the graph exactly as over the in-memory CSR.
+
+// Most runs merged at once. Each run of a merge reads through its own slice of the budget, so
+// this also keeps the slices large enough for long sequential reads.
+const size_t EXTERNAL_MERGE_FAN_IN = 64;
+
+// Bytes moved by the external sort, reported by the semi-external mode. The run bytes include
+// the intermediate merge passes.
+struct ExternalSortReport {
+    uint64_t runs = 0;
+    uint64_t mergePasses = 0; // Passes that merge groups of runs into longer runs, before the final merge
+    uint64_t runBytesWritten = 0;
+    uint64_t runBytesRead = 0;
+    uint64_t graphBytesWritten = 0;
+};
+
+// One direction of an edge: the adjacency entry of source
+struct ExternalEntry {
+    uint32_t source;
+    uint32_t target;
+    uint32_t edge;
+
+    bool operator<(const ExternalEntry &other) const {
+        return source != other.source ? source < other.source : edge < other.edge;
+    }
+};
+
+// Sorted runs stored one after the other in a temporary file: run r holds the entries
+// bounds[r] .. bounds[r+1]-1 of the file
+class ExternalRunFile {
+public:
+    ExternalRunFile() = default;
+    ExternalRunFile(const ExternalRunFile &) = delete;
+    ExternalRunFile &operator=(const ExternalRunFile &) = delete;
+
+    ~ExternalRunFile() {
+        if (file != nullptr) fclose(file);
+    }
+
+    bool open() {
+        file = tmpfile();
+        bounds.assign(1, 0);
+        return file != nullptr;
+    }
+
+    // Appends entries to the run being written
+    bool write(const ExternalEntry *entries, size_t count, ExternalSortReport &report) {
+        if (fwrite(entries, sizeof(ExternalEntry), count, file) != count) return false;
+        written += count;
+        report.runBytesWritten += count * sizeof(ExternalEntry);
+        return true;
+    }
+
+    // Ends the run being written; the runs can be read once all of them are ended and flushed
+    void endRun() {
+        bounds.push_back(written);
+    }
+
+    bool flush() {
+        return fflush(file) == 0;
+    }
+
+    size_t runs() const {
+        return bounds.size() - 1;
+    }
+
+    int descriptor() const {
+        return fileno(file);
+    }
+
+    uint64_t begin(size_t run) const {
+        return bounds[run];
+    }
+
+    uint64_t end(size_t run) const {
+        return bounds[run + 1];
+    }
+
+    void swap(ExternalRunFile &other) {
+        std::swap(file, other.file);
+        std::swap(written, other.written);
+        bounds.swap(other.bounds);
+    }
+
+private:
+    FILE *file = nullptr;
+    uint64_t written = 0;
+    std::vector<uint64_t> bounds;
+};
+
+// A run of an ExternalRunFile, read back a block at a time during a merge
+class ExternalRun {
+public:
+    ExternalRun(const ExternalRunFile &runs, size_t run, size_t blockEntries)
+        : fd(runs.descriptor()), start(runs.begin(run)), end(runs.end(run)), pos(0), failed(false) {
+        buffer.reserve(blockEntries);
+    }
+
+    // Moves to the next entry; false at the end of the run or on a read error (see failed)
+    bool next(ExternalEntry &entry, uint64_t &bytesRead) {
+        if (pos == buffer.size()) {
+            size_t count = (size_t)std::min<uint64_t>(buffer.capacity(), end - start);
+            if (count == 0) return false;
+            buffer.resize(count);
+            ssize_t bytes = pread(fd, buffer.data(), count * sizeof(ExternalEntry), (off_t)(start * sizeof(ExternalEntry)));
+            if (bytes != (ssize_t)(count * sizeof(ExternalEntry))) {
+                failed = true;
+                return false;
+            }
+            bytesRead += bytes;
+            start += count;
+            pos = 0;
+        }
+        entry = buffer[pos++];
+        return true;
+    }
+
+    bool readFailed() const {
+        return failed;
+    }
+
+private:
+    int fd;
+    uint64_t start, end; // Entries of the run not read yet
+    std::vector<ExternalEntry> buffer;
+    size_t pos;
+    bool failed;
+};
+
+// Merges the runs first .. last-1 with a heap, calling output(entry) for every entry in order.
+// Stops and returns false when output returns false or a run cannot be read.
+template <class Output>
+bool mergeExternalRuns(const ExternalRunFile &runs, size_t first, size_t last, size_t blockEntries, ExternalSortReport &report, Output output) {
+    std::vector<ExternalRun> readers;
+    readers.reserve(last - first);
+    typedef std::pair<ExternalEntry, size_t> HeapItem;
+    auto later = [](const HeapItem &a, const HeapItem &b) { return b.first < a.first; };
+    std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(later)> heap(later);
+    for (size_t r = first; r < last; r++) {
+        readers.emplace_back(runs, r, blockEntries);
+        ExternalEntry entry;
+        if (readers.back().next(entry, report.runBytesRead)) heap.push({entry, readers.size() - 1});
+    }
+    while (!heap.empty()) {
+        HeapItem item = heap.top();
+        heap.pop();
+        if (!output(item.first)) return false;
+        ExternalEntry entry;
+        if (readers[item.second].next(entry, report.runBytesRead)) heap.push({entry, item.second});
+    }
+    for (const ExternalRun &reader : readers) {
+        if (reader.readFailed()) {
+            fprintf(stderr, "Error reading a temporary run of the external sort\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sorts the chunk and appends it to runs as a new run
+inline bool writeExternalRun(std::vector<ExternalEntry> &chunk, ExternalRunFile &runs, ExternalSortReport &report) {
+    std::sort(chunk.begin(), chunk.end());
+    if (!runs.write(chunk.data(), chunk.size(), report)) {
+        fprintf(stderr, "Error writing a temporary run of the external sort\n");
+        return false;
+    }
+    runs.endRun();
+    report.runs++;
+    chunk.clear();
+    return true;
+}
+
+// Merges groups of EXTERNAL_MERGE_FAN_IN runs into longer runs until at most that many are
+// left, writing each pass to a new temporary file
+inline bool reduceExternalRuns(ExternalRunFile &runs, size_t budget, ExternalSortReport &report) {
+    // One slice of the budget for each run read and one for the output block
+    size_t blockEntries = std::max<size_t>(budget / sizeof(ExternalEntry) / (EXTERNAL_MERGE_FAN_IN + 1), 256);
+    std::vector<ExternalEntry> block;
+    block.reserve(blockEntries);
+    while (runs.runs() > EXTERNAL_MERGE_FAN_IN) {
+        ExternalRunFile merged;
+        bool written = merged.open();
+        auto flushBlock = [&]() {
+            written = written && merged.write(block.data(), block.size(), report);
+            block.clear();
+            return written;
+        };
+        for (size_t first = 0; first < runs.runs() && written; first += EXTERNAL_MERGE_FAN_IN) {
+            size_t last = std::min(runs.runs(), first + EXTERNAL_MERGE_FAN_IN);
+            bool read = mergeExternalRuns(runs, first, last, blockEntries, report, [&](const ExternalEntry &entry) {
+                block.push_back(entry);
+                return block.size() < blockEntries || flushBlock();
+            });
+            if (!read && written) return false;
+            flushBlock();
+            merged.endRun();
+        }
+        if (!written || !merged.flush()) {
+            fprintf(stderr, "Error writing a temporary run of the external sort\n");
+            return false;
+        }
+        runs.swap(merged);
+        report.mergePasses++;
+    }
+    return true;
+}
+
+// Reads the nEdges edges (pairs of 1-based endpoints) of a graph with nVertexs vertices and
+// writes its graph file to path, using about budget bytes for the sort buffers
+template <class Reader>
+bool buildCSRFileExternal(Reader &reader, int nVertexs, int nEdges, const char *path, size_t budget, ExternalSortReport &report) {
+    size_t chunkEntries = std::max<size_t>(budget / sizeof(ExternalEntry), 2);
+    std::vector<ExternalEntry> chunk;
+    chunk.reserve(chunkEntries);
+    ExternalRunFile runs;
+    if (!runs.open()) {
+        fprintf(stderr, "Error writing a temporary run of the external sort\n");
+        return false;
+    }
+    std::vector<uint32_t> offsets((size_t)nVertexs + 1, 0);
+
+    for (int i = 0; i < nEdges; i++) {
+        int Vertex1, Vertex2;
+        if (!reader.readInt(Vertex1) || !reader.readInt(Vertex2) ||
+            Vertex1 < 1 || Vertex1 > nVertexs || Vertex2 < 1 || Vertex2 > nVertexs) {
+            fprintf(stderr, "Error reading Vertex1 and Vertex2 at iteration %d\n", i);
+            return false;
+        }
+        offsets[Vertex1]++;
+        offsets[Vertex2]++;
+        if (chunk.size() + 2 > chunkEntries && !writeExternalRun(chunk, runs, report)) {
+            return false;
+        }
+        chunk.push_back({(uint32_t)Vertex1 - 1, (uint32_t)Vertex2 - 1, (uint32_t)i});
+        chunk.push_back({(uint32_t)Vertex2 - 1, (uint32_t)Vertex1 - 1, (uint32_t)i});
+    }
+    if (!chunk.empty() && !writeExternalRun(chunk, runs, report)) {
+        return false;
+    }
+    chunk = std::vector<ExternalEntry>();
+    if (!runs.flush()) {
+        fprintf(stderr, "Error writing a temporary run of the external sort\n");
+        return false;
+    }
+    if (!reduceExternalRuns(runs, budget, report)) {
+        return false;
+    }
+    for (int v = 1; v <= nVertexs; v++) {
+        offsets[v] += offsets[v-1];
+    }
+
+    // The targets and the edge indexes go to two regions of the file, written in parallel
+    // through two handles
+    CSRFileHeader header = csrHeader(nVertexs, nEdges, offsets.data());
+    size_t nPositions = 2 * (size_t)nEdges;
+    long targetsStart = (long)(sizeof(header) + sizeof(uint32_t) * ((size_t)nVertexs + 1));
+    long edgesStart = targetsStart + (long)(sizeof(uint32_t) * nPositions);
+    FILE *targets = fopen(path, "wb+");
+    FILE *edges = targets == nullptr ? nullptr : fopen(path, "rb+");
+    bool written = edges != nullptr &&
+                   fwrite(&header, sizeof(header), 1, targets) == 1 &&
+                   fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), targets) == offsets.size() &&
+                   fseek(edges, edgesStart, SEEK_SET) == 0;
+
+    size_t blockEntries = std::max<size_t>(budget / sizeof(ExternalEntry) / std::max<size_t>(runs.runs(), 1), 256);
+    std::vector<uint32_t> targetBlock, edgeBlock;
+    targetBlock.reserve(blockEntries);
+    edgeBlock.reserve(blockEntries);
+    auto flushBlocks = [&]() {
+        written = written &&
+                  fwrite(targetBlock.data(), sizeof(uint32_t), targetBlock.size(), targets) == targetBlock.size() &&
+                  fwrite(edgeBlock.data(), sizeof(uint32_t), edgeBlock.size(), edges) == edgeBlock.size();
+        targetBlock.clear();
+        edgeBlock.clear();
+        return written;
+    };
+    bool merged = written && mergeExternalRuns(runs, 0, runs.runs(), blockEntries, report, [&](const ExternalEntry &entry) {
+        targetBlock.push_back(entry.target);
+        edgeBlock.push_back(entry.edge);
+        return targetBlock.size() < blockEntries || flushBlocks();
+    });
+    flushBlocks();
+
+    if (targets != nullptr && fclose(targets) != 0) written = false;
+    if (edges != nullptr && fclose(edges) != 0) written = false;
+    if (!written) {
+        fprintf(stderr, "Error writing %s\n", path);
+        return false;
+    }
+    if (!merged) {
+        return false;
+    }
+    report.graphBytesWritten = edgesStart + sizeof(uint32_t) * nPositions;
+    return true;
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef FASTIO_HPP
+#define FASTIO_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Reads integers with scanf, as the original program did
+class StdioReader {
+public:
+    bool open(const char *path) {
+        return path == nullptr || freopen(path, "r", stdin) != nullptr;
+    }
+
+    bool readInt(int &value) {
+        return scanf("%d", &value) == 1;
+    }
+};
+
+// Writes integers with printf, as the original program did
+class StdioWriter {
+public:
+    void writeInt(long long value) {
+        printf("%lld", value);
+    }
+
+    void writeChar(char c) {
+        putchar(c);
+    }
+
+    void writeBytes(const char *bytes, size_t count) {
+        fwrite(bytes, 1, count, stdout);
+    }
+
+    void flush() {
+        fflush(stdout);
+    }
+};
+
+// Reads decimal integers straight from memory. Regular files (including stdin redirected
+// from a file) are mapped with mmap and parsed in place; pipes are read in big chunks into
+// a buffer that is refilled as the parser advances. Digit runs are found 16 bytes at a time
+// with SSE2 and converted 8 digits at a time with SWAR arithmetic.
+class FastReader {
+public:
+    FastReader() : data(nullptr), size(0), pos(0), mapped(false), fd(-1), eof(false) {}
+
+    ~FastReader() {
+        if (mapped) munmap((void *)data, size);
+        if (fd > 0) close(fd);
+    }
+
+    bool open(const char *path) {
+        fd = path == nullptr ? 0 : ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, info.st_size, MADV_SEQUENTIAL);
+                data = (const char *)map;
+                size = info.st_size;
+                mapped = true;
+                eof = true;
+                return true;
+            }
+        }
+
+        buffer.resize(CHUNK + PADDING);
+        data = buffer.data();
+        refill();
+        return true;
+    }
+
+    bool readInt(int &value) {
+        // Skip separators, refilling near the end of the buffer when reading a pipe
+        for (;;) {
+            if (pos + PADDING > size && !eof) refill();
+            if (pos >= size) return false;
+            char c = data[pos];
+            if ((unsigned)(c - '0') < 10 || c == '-') break;
+            pos++;
+        }
+
+        bool negative = data[pos] == '-';
+        if (negative) {
+            pos++;
+            if (pos >= size || (unsigned)(data[pos] - '0') >= 10) return false;
+        }
+
+        uint64_t result = 0;
+        size_t length = digitRun();
+        while (length >= 8) {
+            result = result * 100000000 + parseEightDigits(data + pos);
+            pos += 8;
+            length -= 8;
+        }
+        if (length > 0) {
+            result = result * powersOfTen(length) + parseDigits(data + pos, length);
+            pos += length;
+        }
+
+        value = negative ? -(int)result : (int)result;
+        return true;
+    }
+
+private:
+    static const size_t CHUNK = 1 << 20;
+    static const size_t PADDING = 64; // Longer than any integer, so a number never crosses a refill
+
+    const char *data;
+    size_t size;
+    size_t pos;
+    bool mapped;
+    int fd;
+    bool eof;
+    std::vector<char> buffer;
+
+    // Moves the unread bytes to the front of the buffer and reads after them until they hold a
+    // whole integer. A read returns whatever the pipe already has, so input that arrives in
+    // pieces (-s) is parsed as soon as each number is complete instead of after a full chunk.
+    void refill() {
+        size_t left = size - pos;
+        memmove(buffer.data(), buffer.data() + pos, left);
+        size = left;
+        pos = 0;
+        while (size < CHUNK && !eof && !completeInt()) {
+            ssize_t bytes = read(fd, buffer.data() + size, CHUNK - size);
+            if (bytes <= 0) eof = true;
+            else size += bytes;
+        }
+    }
+
+    // Whether the unread bytes hold an integer and the byte that ends it
+    bool completeInt() const {
+        size_t end = pos;
+        while (end < size && (unsigned)(data[end] - '0') >= 10 && data[end] != '-') end++;
+        if (end < size && data[end] == '-') end++;
+        while (end < size && (unsigned)(data[end] - '0') < 10) end++;
+        return end < size;
+    }
+
+    // Length of the run of digits starting at pos
+    size_t digitRun() const {
+        size_t end = pos;
+#ifdef __SSE2__
+        const __m128i below = _mm_set1_epi8('0' - 1);
+        const __m128i above = _mm_set1_epi8('9' + 1);
+        while (end + 16 <= size) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)(data + end));
+            __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chunk, below), _mm_cmplt_epi8(chunk, above));
+            unsigned mask = ~(unsigned)_mm_movemask_epi8(digits) & 0xFFFF;
+            if (mask != 0) return end - pos + __builtin_ctz(mask);
+            end += 16;
+        }
+#endif
+        while (end < size && (unsigned)(data[end] - '0') < 10) end++;
+        return end - pos;
+    }
+
+    // Converts exactly 8 digits: each step merges neighbouring groups of 1, 2 and 4 digits
+    static uint32_t parseEightDigits(const char *digits) {
+        uint64_t chunk;
+        memcpy(&chunk, digits, 8);
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+        chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+        chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+        return (uint32_t)chunk;
+    }
+
+    static uint32_t parseDigits(const char *digits, size_t length) {
+        uint32_t result = 0;
+        for (size_t i = 0; i < length; i++) {
+            result = result * 10 + (digits[i] - '0');
+        }
+        return result;
+    }
+
+    static uint64_t powersOfTen(size_t length) {
+        static const uint64_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+        return powers[length];
+    }
+};
+
+static constexpr const char *DIGIT_PAIRS =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes value in decimal at out, two digits at a time, and returns its length (at most 20)
+inline size_t formatInt(long long value, char *out) {
+    size_t length = 0;
+    unsigned long long magnitude = value;
+    if (value < 0) {
+        out[length++] = '-';
+        magnitude = 0ULL - magnitude;
+    }
+
+    char digits[24];
+    int end = sizeof(digits);
+    while (magnitude >= 100) {
+        unsigned pair = (unsigned)(magnitude % 100) * 2;
+        magnitude /= 100;
+        digits[--end] = DIGIT_PAIRS[pair + 1];
+        digits[--end] = DIGIT_PAIRS[pair];
+    }
+    if (magnitude >= 10) {
+        unsigned pair = (unsigned)magnitude * 2;
+        digits[--end] = DIGIT_PAIRS[pair + 1];
+        digits[--end] = DIGIT_PAIRS[pair];
+    } else {
+        digits[--end] = (char)('0' + magnitude);
+    }
+
+    memcpy(out + length, digits + end, sizeof(digits) - end);
+    return length + sizeof(digits) - end;
+}
+
+// Collects the output in a large buffer, formatting integers two digits at a time
+class FastWriter {
+public:
+    FastWriter() : buffer(SIZE), length(0) {}
+
+    ~FastWriter() {
+        flush();
+    }
+
+    void writeInt(long long value) {
+        if (length + 24 > SIZE) flush();
+        length += formatInt(value, buffer.data() + length);
+    }
+
+    void writeChar(char c) {
+        if (length == SIZE) flush();
+        buffer[length++] = c;
+    }
+
+    void writeBytes(const char *bytes, size_t count) {
+        if (length + count > SIZE) {
+            flush();
+            if (count > SIZE) {
+                fwrite(bytes, 1, count, stdout);
+                return;
+            }
+        }
+        memcpy(buffer.data() + length, bytes, count);
+        length += count;
+    }
+
+    void flush() {
+        fwrite(buffer.data(), 1, length, stdout);
+        fflush(stdout);
+        length = 0;
+    }
+
+private:
+    static const size_t SIZE = 1 << 20;
+
+    std::vector<char> buffer;
+    size_t length;
+};
+
+// Appends the output to a vector owned by the caller, so it can be formatted by one thread
+// and written later by another. Clearing the vector keeps its memory for the next use.
+class BufferWriter {
+public:
+    explicit BufferWriter(std::vector<char> &output) : output(output) {}
+
+    void writeInt(long long value) {
+        char digits[24];
+        output.insert(output.end(), digits, digits + formatInt(value, digits));
+    }
+
+    void writeChar(char c) {
+        output.push_back(c);
+    }
+
+    void writeBytes(const char *bytes, size_t count) {
+        output.insert(output.end(), bytes, bytes + count);
+    }
+
+    void flush() {}
+
+private:
+    std::vector<char> &output;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef REORDER_HPP
+#define REORDER_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include "biconnectivity.hpp"
+
+// Vertex orders that give adjacent vertices nearby ids, so the per-vertex arrays touched by
+// the DFS are read from the same cache lines instead of at random:
+//  - BFS_ORDER numbers the vertices as a BFS from each unvisited vertex reaches them;
+//  - RCM_ORDER is reverse Cuthill-McKee: a BFS started at a vertex of smallest degree that
+//    visits the neighbours by increasing degree, numbered backwards, which keeps the
+//    bandwidth of the adjacency matrix small;
+//  - DEGREE_ORDER puts the vertices of largest degree first, so the hubs share cache lines.
+enum VertexOrder { INPUT_ORDER, BFS_ORDER, RCM_ORDER, DEGREE_ORDER };
+
+// Fills originalId with the vertices (0-based) in the given order, so the vertex with the
+// new id v is originalId[v]
+template <class Id>
+void computeOrder(const CSRGraphView<Id> &graph, Id nVertexs, VertexOrder order, std::vector<Id> &originalId) {
+    originalId.resize(nVertexs);
+    for (Id v = 0; v < nVertexs; v++) originalId[v] = v;
+    auto degree = [&graph](Id v) { return graph.offsets[v+1] - graph.offsets[v]; };
+    if (order == INPUT_ORDER) return;
+    if (order == DEGREE_ORDER) {
+        // Largest degree first; ties keep the smaller id first
+        std::stable_sort(originalId.begin(), originalId.end(), [&degree](Id a, Id b) { return degree(a) > degree(b); });
+        return;
+    }
+
+    std::vector<Id> starts(originalId);
+    if (order == RCM_ORDER) {
+        std::stable_sort(starts.begin(), starts.end(), [&degree](Id a, Id b) { return degree(a) < degree(b); });
+    }
+
+    // BFS from every unvisited vertex, in id order for BFS_ORDER and by increasing degree for
+    // RCM_ORDER, which also visits the neighbours of each vertex by increasing degree
+    std::vector<char> visited(nVertexs, 0);
+    std::vector<Id> neighbours;
+    Id tail = 0;
+    for (Id i = 0; i < nVertexs; i++) {
+        Id start = starts[i];
+        if (visited[start]) continue;
+        visited[start] = 1;
+        originalId[tail++] = start;
+        for (Id head = tail - 1; head < tail; head++) {
+            Id u = originalId[head];
+            neighbours.clear();
+            for (Id k = graph.offsets[u]; k < graph.offsets[u+1]; k++) {
+                Id w = graph.targets[k];
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    neighbours.push_back(w);
+                }
+            }
+            if (order == RCM_ORDER) {
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&degree](Id a, Id b) { return degree(a) < degree(b); });
+            }
+            for (Id w : neighbours) originalId[tail++] = w;
+        }
+    }
+    if (order == RCM_ORDER) {
+        std::reverse(originalId.begin(), originalId.end());
+    }
+}
+
+// Builds the graph with the vertices renamed: the vertex v of graph becomes the vertex with
+// new id v of relabeled, where originalId lists the old id of every new one. Each vertex
+// keeps its adjacent vertices in the same order and every edge keeps its input index.
+template <class Id>
+void relabelCSR(const CSRGraphView<Id> &graph, Id nVertexs, const std::vector<Id> &originalId, CSRStorage<Id> &relabeled) {
+    std::vector<Id> newId(nVertexs);
+    for (Id v = 0; v < nVertexs; v++) newId[originalId[v]] = v;
+
+    relabeled.offsets.resize((size_t)nVertexs + 1);
+    relabeled.offsets[0] = 0;
+    for (Id v = 0; v < nVertexs; v++) {
+        Id old = originalId[v];
+        relabeled.offsets[v+1] = relabeled.offsets[v] + (graph.offsets[old+1] - graph.offsets[old]);
+    }
+    relabeled.targets.resize(relabeled.offsets[nVertexs]);
+    relabeled.edges.resize(relabeled.offsets[nVertexs]);
+    for (Id v = 0; v < nVertexs; v++) {
+        Id old = originalId[v];
+        Id position = relabeled.offsets[v];
+        for (Id k = graph.offsets[old]; k < graph.offsets[old+1]; k++, position++) {
+            relabeled.targets[position] = newId[graph.targets[k]];
+            relabeled.edges[position] = graph.edges[k];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run parallel loops. The thread calling parallelFor
+// works as worker 0, so a pool of one thread runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(int nThreads) : generation(0), running(0), stopping(false) {
+        for (int worker = 1; worker < nThreads; worker++) {
+            threads.emplace_back([this, worker] { workerLoop(worker); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads) thread.join();
+    }
+
+    int size() const {
+        return (int)threads.size() + 1;
+    }
+
+    // Calls body(begin, end, worker) over chunks of [0, n) until the whole range is covered.
+    // Chunks are taken from a shared counter, so threads that finish early take more of them.
+    template <class Body>
+    void parallelFor(size_t n, Body body, size_t minChunk = 1024) {
+        if (n == 0) return;
+        size_t chunk = std::max(minChunk, n / (8 * (size_t)size()) + 1);
+        if (threads.empty() || n <= chunk) {
+            body((size_t)0, n, 0);
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        auto job = [&](int worker) {
+            for (;;) {
+                size_t begin = next.fetch_add(chunk);
+                if (begin >= n) break;
+                body(begin, std::min(n, begin + chunk), worker);
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = job;
+            running = (int)threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        job(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return running == 0; });
+        task = nullptr;
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::function<void(int)> task;
+    unsigned long generation;
+    int running;
+    bool stopping;
+
+    void workerLoop(int worker) {
+        unsigned long seen = 0;
+        for (;;) {
+            std::function<void(int)> current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = task;
+            }
+            current(worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--running == 0) done.notify_one();
+            }
+        }
+    }
+};
+
+#endif
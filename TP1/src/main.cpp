@@ -1,196 +1,779 @@
 #include <algorithm>
-#include <climits>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
-#include <list>
-#include <set>
-#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
 #include <vector>
 
+#include "biconnectivity.hpp"
+#include "block_cut_forest.hpp"
+#include "block_cut_index.hpp"
+#include "csr_file.hpp"
+#include "external_csr.hpp"
+#include "fastio.hpp"
+#include "reorder.hpp"
+#include "thread_pool.hpp"
+
 using namespace std;
 
-// Class to represent a vertex in the graph
-class Vertex {
+// The input counts are ints, so 32-bit ids are enough and keep every array compact
+typedef Biconnectivity<uint32_t> ClusterFinder;
+typedef CSRGraphView<uint32_t> CSRGraph;
+
+// What is printed for the graph: articulation points, clusters and forest; the cluster of
+// each edge; the result followed by the changes of each inserted edge; only the answers
+// to separation queries; or the result followed by the bridges and 2-edge-connected components
+enum OutputMode { RESULT, LABELS, STREAM, QUERIES, BRIDGES };
+
+struct Options {
+    OutputMode mode = RESULT;
+    bool fastIO = false;
+    bool batch = false;
+    bool timing = false;
+    bool stats = false;
+    const char *inputPath = nullptr;
+    const char *graphPath = nullptr;
+    const char *convertPath = nullptr;
+    int nThreads = 0;
+    int nWorkers = 1;
+    size_t memoryBudget = 0; // Bytes for the external sort of -M; 0 keeps the graph in memory
+    VertexOrder order = INPUT_ORDER;
+};
+
+// Wall time of the phases of a run, printed by -t on stderr as one CSV row in milliseconds
+enum Phase { PARSE, BUILD, CLUSTERS, SORT, OUTPUT, N_PHASES };
+
+class PhaseTimer {
 public:
-    int discoveryTime; // Time when the vertex was discovered during DFS
-    int lowLink; // Lowest discovery time reachable from the vertex
-    Vertex() : discoveryTime(0), lowLink(INT_MAX) {}
+    PhaseTimer() : last(chrono::steady_clock::now()), elapsed() {}
+
+    // Adds the time since the previous call to the phase
+    void lap(Phase phase) {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        elapsed[phase] += chrono::duration<double, milli>(now - last).count();
+        last = now;
+    }
 
-    void updateDiscoveryTime(int newTime) {
-        discoveryTime = newTime;
+    void report() const {
+        fprintf(stderr, "%.3f,%.3f,%.3f,%.3f,%.3f\n", elapsed[PARSE], elapsed[BUILD], elapsed[CLUSTERS], elapsed[SORT], elapsed[OUTPUT]);
     }
 
-    void updateLowLink(int newLow) {
-        lowLink = min(lowLink, newLow);
+    double milliseconds(Phase phase) const {
+        return elapsed[phase];
     }
+
+private:
+    chrono::steady_clock::time_point last;
+    double elapsed[N_PHASES];
 };
 
-vector<Vertex> vertices; 
-set<int> links; // Store edge links in a set, as they need to be printed in ascending order
-int nClusters = 0;
+// Totals printed by --stats, summed over the graphs of a run
+struct RunStats {
+    uint64_t graphs = 0;
+    uint64_t vertexs = 0;
+    uint64_t edges = 0;
+    uint64_t links = 0;
+    uint64_t clusters = 0;
+    uint64_t maxDepth = 0; // Deepest vertex of the DFS trees (0 with the parallel algorithm)
+    ClusterFinder::Counters counters;
+
+    void add(const ClusterFinder &finder, int nVertexs, int nEdges) {
+        graphs++;
+        vertexs += nVertexs;
+        edges += nEdges;
+        links += finder.nLinks;
+        clusters += finder.nClusters;
+        for (const Vertex<uint32_t> &vertex : finder.vertices) {
+            maxDepth = max<uint64_t>(maxDepth, vertex.discoveryTime);
+        }
+    }
 
-typedef pair<int, int> Edge;
+    // Adds the totals of another run; the counters are taken apart, as they are kept by the finders
+    void merge(const RunStats &other) {
+        graphs += other.graphs;
+        vertexs += other.vertexs;
+        edges += other.edges;
+        links += other.links;
+        clusters += other.clusters;
+        maxDepth = max(maxDepth, other.maxDepth);
+    }
 
-list<Edge> EdgeList;
-set<set<int>> clusters; // Clusters must be sorted lexicographically. Ou seja, se temos os clusters a = {1, 3, 7} e b = {1, 2, 100}, o cluster b deve ser listado antes do cluster a, e, portanto, possuir um identificador menor.
-set<set<int>> forest;
-typedef set<int> VertexSet;
+    void addCounters(const ClusterFinder::Counters &finderCounters) {
+        counters.edgesPushed += finderCounters.edgesPushed;
+        counters.edgesPopped += finderCounters.edgesPopped;
+        counters.clusters += finderCounters.clusters;
+        counters.maxEdgeStack = max(counters.maxEdgeStack, finderCounters.maxEdgeStack);
+    }
 
-// Function to identify and retrieve clusters in the graph
-void findClusters(int u, int v) {
-    VertexSet clusterVertices;
-    list<Edge> tempEdgeList; // Temporary stack to hold the edges of the current cluster
+    // Prints the totals and the phase times as one JSON object on stderr
+    void report(const PhaseTimer &timer) const {
+        fprintf(stderr, "{\"graphs\":%llu,\"vertices\":%llu,\"edges\":%llu,\"links\":%llu,\"clusters\":%llu,"
+                "\"edges_pushed\":%llu,\"edges_popped\":%llu,\"max_edge_stack\":%llu,\"max_dfs_depth\":%llu,"
+                "\"phases_ms\":{\"parse\":%.3f,\"build\":%.3f,\"clusters\":%.3f,\"sort\":%.3f,\"output\":%.3f}}\n",
+                (unsigned long long)graphs, (unsigned long long)vertexs, (unsigned long long)edges,
+                (unsigned long long)links, (unsigned long long)clusters,
+                (unsigned long long)counters.edgesPushed, (unsigned long long)counters.edgesPopped,
+                (unsigned long long)counters.maxEdgeStack, (unsigned long long)maxDepth,
+                timer.milliseconds(PARSE), timer.milliseconds(BUILD), timer.milliseconds(CLUSTERS),
+                timer.milliseconds(SORT), timer.milliseconds(OUTPUT));
+    }
+};
 
-    // Pop edges from EdgeList until we find the edge that starts the current cluster
-    while (!EdgeList.empty() && (EdgeList.back().first != u || EdgeList.back().second != v)) {
-        tempEdgeList.push_front(EdgeList.back()); // Move the edge to the temporary stack
-        EdgeList.pop_back();
+// Reads the edges (pairs of 1-based endpoints) of the graph
+template <class Reader>
+bool readEdges(Reader &reader, int nVertexs, int nEdges, vector<uint32_t> &endpoints) {
+    if (nVertexs < 0 || nEdges < 0) {
+        fprintf(stderr, "Invalid nVertexs and nEdges: %d %d\n", nVertexs, nEdges);
+        return false;
     }
 
-    // If we found the starting edge, add it to the temporary stack
-    if (!EdgeList.empty()) {
-        tempEdgeList.push_front(EdgeList.back());
-        EdgeList.pop_back();
+    endpoints.resize(2 * (size_t)nEdges);
+    for (int i = 0; i < nEdges; i++) {
+        int Vertex1, Vertex2;
+        if (!reader.readInt(Vertex1) || !reader.readInt(Vertex2) ||
+            Vertex1 < 1 || Vertex1 > nVertexs || Vertex2 < 1 || Vertex2 > nVertexs) {
+            fprintf(stderr, "Error reading Vertex1 and Vertex2 at iteration %d\n", i);
+            return false;
+        }
+
+        endpoints[2*i] = Vertex1;
+        endpoints[2*i+1] = Vertex2;
     }
+    return true;
+}
 
-    // Now, tempEdgeList contains the edges of the current cluster in reverse order
-    // Add Vertexs to the cluster in the correct order
-    while (!tempEdgeList.empty()) {
-        Edge edge = tempEdgeList.front();
-        tempEdgeList.pop_front();
-        clusterVertices.insert(edge.first);
-        clusterVertices.insert(edge.second);
+// Reads the number of vertices and the edges of the graph
+template <class Reader>
+bool readGraph(Reader &reader, int &nVertexs, int &nEdges, vector<uint32_t> &endpoints) {
+    if (!reader.readInt(nVertexs) || !reader.readInt(nEdges)) {
+        fprintf(stderr, "Error reading nVertexs and nEdges\n");
+        return false;
     }
+    return readEdges(reader, nVertexs, nEdges, endpoints);
+}
 
-    // Add the cluster to the set of clusters
-    clusters.insert(clusterVertices);
-    nClusters++;
+// Outputs the cluster of each edge, in input order
+template <class Writer>
+void printLabels(Writer &writer, const ClusterFinder &finder, int nEdges) {
+    writer.writeInt(finder.nClusters);
+    writer.writeChar('\n');
+    for (int e = 0; e < nEdges; e++) {
+        writer.writeInt(finder.blockOf[e]);
+        writer.writeChar('\n');
+    }
 }
 
-// Depth-first search to identify articulation points and clusters
-void dfs(vector<vector<int>> &Graph, int indexVertex, int parent, int time) {
-    time++;
-    vertices[indexVertex].updateDiscoveryTime(time); 
-    vertices[indexVertex].updateLowLink(time); 
-    int children = 0;
-    vector<int>& adjacentes = Graph[indexVertex];
+// Outputs the articulation points, the clusters and the forest
+template <class Writer>
+void printResult(Writer &writer, ClusterFinder &finder, int nVertexs, const vector<uint32_t> &order) {
+    // Output the number of articulation points
+    writer.writeInt(finder.nLinks);
+    writer.writeChar('\n');
+    for (int v = 0; v < nVertexs; v++) {
+        if (finder.isLink[v]) {
+            writer.writeInt(v+1);
+            writer.writeChar('\n');
+        }
+    }
 
-    for(int i = 0; i < (int)adjacentes.size(); i++) {
-        if(vertices[adjacentes[i]-1].discoveryTime == 0) { 
-            children++;
-            EdgeList.push_back(make_pair(indexVertex+1, adjacentes[i])); 
+    // Output the number of clusters
+    writer.writeInt(finder.nClusters);
+    writer.writeChar('\n');
 
-            dfs(Graph, adjacentes[i]-1, indexVertex+1, time);
+    // Output clusters
+    for (uint32_t i = 0; i < finder.nClusters; i++) {
+        uint32_t c = order[i];
+        writer.writeInt(nVertexs+i+1);
+        writer.writeChar(' ');
+        writer.writeInt(finder.clusterOffsets[c+1] - finder.clusterOffsets[c]);
+        writer.writeChar(' ');
+        for (uint32_t k = finder.clusterOffsets[c]; k < finder.clusterOffsets[c+1]; k++) {
+            writer.writeInt(finder.clusterMembers[k]);
+            writer.writeChar(k+1 == finder.clusterOffsets[c+1] ? '\n' : ' ');
+        }
+    }
 
-            if(vertices[adjacentes[i]-1].lowLink < vertices[indexVertex].lowLink) {
-                vertices[indexVertex].updateLowLink(vertices[adjacentes[i]-1].lowLink);
-            }
-            
-            if(parent != -1 && vertices[adjacentes[i]-1].lowLink >= vertices[indexVertex].discoveryTime) {
-                links.insert(indexVertex+1);               
-            }
+    // Output forest
+    finder.buildForest(nVertexs, order);
+    writer.writeInt(finder.nClusters+finder.nLinks);
+    writer.writeChar(' ');
+    writer.writeInt(finder.forestClusters.size());
+    writer.writeChar('\n');
+    for (int v = 0; v < nVertexs; v++) {
+        for (uint32_t k = finder.forestOffsets[v]; k < finder.forestOffsets[v+1]; k++) {
+            writer.writeInt(v+1);
+            writer.writeChar(' ');
+            writer.writeInt(nVertexs+finder.forestClusters[k]+1);
+            writer.writeChar('\n');
+        }
+    }
+}
 
-            if((vertices[indexVertex].discoveryTime == 1 && children > 1) || (vertices[indexVertex].discoveryTime > 1 && vertices[adjacentes[i]-1].lowLink >= vertices[indexVertex].discoveryTime)) {
-                findClusters(indexVertex+1, adjacentes[i]);
-            }
+// Outputs the bridges, as 1-based indexes of the input edges in ascending order, and the
+// 2-edge-connected component of each vertex
+template <class Writer>
+void printBridges(Writer &writer, const ClusterFinder &finder, int nVertexs, int nEdges) {
+    writer.writeInt(finder.nBridges);
+    writer.writeChar('\n');
+    for (int e = 0; e < nEdges; e++) {
+        if (finder.isBridge[e]) {
+            writer.writeInt(e+1);
+            writer.writeChar('\n');
+        }
+    }
 
-        } else if(adjacentes[i] != parent) { 
-            if(vertices[adjacentes[i]-1].discoveryTime < vertices[indexVertex].lowLink) {
-                vertices[indexVertex].updateLowLink(vertices[adjacentes[i]-1].discoveryTime);
-            }
-            if(vertices[adjacentes[i]-1].discoveryTime < vertices[indexVertex].discoveryTime) {
-                EdgeList.push_back(make_pair(indexVertex+1, adjacentes[i]));
-            }
+    writer.writeInt(finder.nEdgeComponents);
+    writer.writeChar('\n');
+    for (int v = 0; v < nVertexs; v++) {
+        writer.writeInt(finder.edgeComponentOf[v]);
+        writer.writeChar('\n');
+    }
+}
+
+// Outputs what one inserted edge changed:
+//   <links> <clusters> <0: nothing, 1: a cluster was created, 2: clusters were merged>
+//   <n> <vertices that became links> <m> <vertices that stopped being links>
+//   <id> 2 <u> <v>             for a created cluster, with the endpoints of the edge
+//   <id> <k> <k cluster ids>   for merged clusters, with the ids merged into the cluster id
+template <class Writer>
+void printChange(Writer &writer, const BlockCutForest &forest) {
+    const BlockCutForest::Change &change = forest.lastChange();
+    writer.writeInt(forest.links());
+    writer.writeChar(' ');
+    writer.writeInt(forest.clusters());
+    writer.writeChar(' ');
+    writer.writeInt(change.kind);
+    writer.writeChar('\n');
+
+    writer.writeInt(change.newLinks.size());
+    for (uint32_t vertex : change.newLinks) {
+        writer.writeChar(' ');
+        writer.writeInt(vertex + 1);
+    }
+    writer.writeChar(' ');
+    writer.writeInt(change.removedLinks.size());
+    for (uint32_t vertex : change.removedLinks) {
+        writer.writeChar(' ');
+        writer.writeInt(vertex + 1);
+    }
+    writer.writeChar('\n');
+
+    if (change.kind == BlockCutForest::Change::NONE) return;
+    writer.writeInt(forest.id(change.cluster));
+    writer.writeChar(' ');
+    if (change.kind == BlockCutForest::Change::CREATED) {
+        writer.writeInt(2);
+        writer.writeChar(' ');
+        writer.writeInt(min(change.u, change.v) + 1);
+        writer.writeChar(' ');
+        writer.writeInt(max(change.u, change.v) + 1);
+    } else {
+        writer.writeInt(change.merged.size());
+        for (uint32_t id : change.merged) {
+            writer.writeChar(' ');
+            writer.writeInt(id);
         }
     }
+    writer.writeChar('\n');
+}
 
-    if(parent == -1 && children > 1) {
-        links.insert(indexVertex+1);      
+// Reads inserted edges until the end of the input, keeping the block-cut forest up to date
+// and printing only what each edge changed
+template <class Reader, class Writer>
+int streamEdges(Reader &reader, Writer &writer, const ClusterFinder &finder, int nVertexs, const vector<uint32_t> &order) {
+    BlockCutForest forest(nVertexs, finder.clusterOffsets, finder.clusterMembers, order);
+    int Vertex1, Vertex2;
+    for (int i = 0; reader.readInt(Vertex1); i++) {
+        if (!reader.readInt(Vertex2) || Vertex1 < 1 || Vertex1 > nVertexs || Vertex2 < 1 || Vertex2 > nVertexs) {
+            fprintf(stderr, "Error reading inserted edge %d\n", i);
+            return 1;
+        }
+        forest.addEdge(Vertex1 - 1, Vertex2 - 1);
+        printChange(writer, forest);
+        writer.flush();
     }
+    return 0;
 }
 
+// Answers separation queries until the end of the input, one line per query:
+//   1 x u v   1 if removing the vertex x disconnects u from v, else 0
+//   2 u v     the number of cut vertices between u and v followed by them, from u to v,
+//             or -1 when u and v are not connected
+// The time to build the index and the query throughput are reported on stderr.
+template <class Reader, class Writer>
+int answerQueries(Reader &reader, Writer &writer, const ClusterFinder &finder, int nVertexs) {
+    auto start = chrono::steady_clock::now();
+    BlockCutIndex index(nVertexs, finder.clusterOffsets, finder.clusterMembers);
+    auto built = chrono::steady_clock::now();
+
+    auto valid = [nVertexs](int vertex) { return vertex >= 1 && vertex <= nVertexs; };
+    vector<uint32_t> between;
+    long long nQueries = 0;
+    int kind;
+    while (reader.readInt(kind)) {
+        int x = 1, u, v;
+        if ((kind != 1 && kind != 2) || (kind == 1 && !reader.readInt(x)) || !reader.readInt(u) || !reader.readInt(v) ||
+            !valid(x) || !valid(u) || !valid(v)) {
+            fprintf(stderr, "Error reading query %lld\n", nQueries + 1);
+            return 1;
+        }
+
+        if (kind == 1) {
+            writer.writeInt(index.separates(x - 1, u - 1, v - 1) ? 1 : 0);
+        } else if (!index.connected(u - 1, v - 1)) {
+            writer.writeInt(-1);
+        } else {
+            between.clear();
+            index.listBetween(u - 1, v - 1, between);
+            writer.writeInt(between.size());
+            for (uint32_t vertex : between) {
+                writer.writeChar(' ');
+                writer.writeInt(vertex + 1);
+            }
+        }
+        writer.writeChar('\n');
+        nQueries++;
+    }
+    writer.flush();
+
+    auto end = chrono::steady_clock::now();
+    double buildSeconds = chrono::duration<double>(built - start).count();
+    double querySeconds = chrono::duration<double>(end - built).count();
+    fprintf(stderr, "Index built in %.3f s; %lld queries in %.3f s (%.0f queries/s)\n",
+            buildSeconds, nQueries, querySeconds, querySeconds > 0 ? nQueries / querySeconds : 0.0);
+    return 0;
+}
 
-int main() {
+// Reads the graph from the text input, or maps it from graphPath when given. With
+// convertPath the graph is only written there as a graph file.
+template <class Reader, class Writer>
+int run(const Options &options) {
     int nVertexs, nEdges;
-    int time = 0;
-    if (scanf("%d %d", &nVertexs, &nEdges) != 2) {
-        fprintf(stderr, "Error reading nVertexs and nEdges\n");
+    OutputMode mode = options.mode;
+    PhaseTimer timer;
+
+    Reader reader;
+    if ((options.graphPath == nullptr || mode == STREAM || mode == QUERIES) && !reader.open(options.inputPath)) {
+        fprintf(stderr, "Error opening %s\n", options.inputPath);
         return 1;
     }
-    vector<vector<int>> Graph(nVertexs);
-    vertices.resize(nVertexs);
 
-    // Read edges of the graph
-    for (int i = 0; i < nEdges; i++) {
-        int Vertex1, Vertex2;
-        if (scanf("%d %d", &Vertex1, &Vertex2) != 2) {
-            fprintf(stderr, "Error reading Vertex1 and Vertex2 at iteration %d\n", i);
+    CSRStorage<uint32_t> storage;
+    CSRFile file;
+    CSRGraph graph;
+    if (options.graphPath != nullptr) {
+        if (!file.open(options.graphPath)) {
+            return 1;
+        }
+        nVertexs = file.vertexCount();
+        nEdges = file.edgeCount();
+        graph = {file.offsets(), file.targets(), file.edges()};
+        timer.lap(PARSE);
+    } else {
+        // Read edges of the graph
+        vector<uint32_t> endpoints;
+        if (!readGraph(reader, nVertexs, nEdges, endpoints)) {
             return 1;
         }
+        timer.lap(PARSE);
+        buildCSR<uint32_t>(storage, nVertexs, endpoints);
+        graph = storage.view();
+        timer.lap(BUILD);
+    }
 
-        Graph[Vertex1 - 1].push_back(Vertex2);
-        Graph[Vertex2 - 1].push_back(Vertex1);
+    if (options.convertPath != nullptr) {
+        return writeCSRFile(options.convertPath, nVertexs, nEdges, graph.offsets, graph.targets, graph.edges) ? 0 : 1;
     }
 
-    // Perform DFS to identify articulation points and clusters
-    for (int i = 0; i < nVertexs; i++) {
-        if (vertices[i].discoveryTime == 0) {
-            dfs(Graph, i, -1, time);
+    // Rename the vertices for locality; the results are translated back before the output
+    CSRStorage<uint32_t> relabeled;
+    vector<uint32_t> originalId;
+    if (options.order != INPUT_ORDER) {
+        computeOrder<uint32_t>(graph, nVertexs, options.order, originalId);
+        relabelCSR<uint32_t>(graph, nVertexs, originalId, relabeled);
+        graph = relabeled.view();
+        storage = CSRStorage<uint32_t>();
+        timer.lap(BUILD);
+    }
+
+    ClusterFinder finder;
+    finder.reset(nVertexs, nEdges, mode != LABELS, mode == BRIDGES);
+
+    if (options.nThreads > 0) {
+        ThreadPool pool(options.nThreads);
+        finder.run(graph, nVertexs, &pool);
+    } else {
+        finder.run(graph, nVertexs, nullptr);
+    }
+    if (options.order != INPUT_ORDER) {
+        finder.restoreIds(nVertexs, originalId);
+    }
+    timer.lap(CLUSTERS);
+
+    Writer writer;
+    int status = 0;
+    if (mode == LABELS) {
+        printLabels(writer, finder, nEdges);
+        writer.flush();
+    } else if (mode == QUERIES) {
+        status = answerQueries(reader, writer, finder, nVertexs);
+    } else {
+        const vector<uint32_t> &order = finder.sortClusters(nVertexs);
+        timer.lap(SORT);
+        printResult(writer, finder, nVertexs, order);
+        if (mode == BRIDGES) {
+            printBridges(writer, finder, nVertexs, nEdges);
         }
-        if (!EdgeList.empty()) {
-            set<int> clusterVertices;
-            while (!EdgeList.empty()) {
-                clusterVertices.insert(EdgeList.back().first);
-                clusterVertices.insert(EdgeList.back().second);
-                EdgeList.pop_back();
-            }
-            clusters.insert(clusterVertices);
-            nClusters++;
+        writer.flush();
+
+        if (mode == STREAM) {
+            status = streamEdges(reader, writer, finder, nVertexs, order);
         }
     }
+    timer.lap(OUTPUT);
 
-    // Output the number of articulation points
-    printf("%d\n", (int)links.size());
-    for(set<int>::iterator itr = links.begin(); itr != links.end(); itr++) {
-        printf("%d\n", *itr);
+    if (options.timing) {
+        timer.report();
+    }
+    if (options.stats) {
+        RunStats stats;
+        stats.add(finder, nVertexs, nEdges);
+        stats.addCounters(finder.counters);
+        stats.report(timer);
     }
+    return status;
+}
 
-    // Output the number of clusters
-    printf("%d\n", nClusters);
+// Semi-external run for graphs whose edges do not fit in memory: the edge list is sorted
+// externally into a graph file (convertPath, or a temporary file removed once mapped), which
+// the DFS reads through the mapping while its own state stays O(nVertexs). The clusters come
+// from a vertex stack, so no per-edge array is allocated. The bytes moved by the sort and the
+// major page faults of the DFS are reported on stderr.
+template <class Reader, class Writer>
+int runSemiExternal(const Options &options) {
+    int nVertexs, nEdges;
+    PhaseTimer timer;
+    Reader reader;
+    if (!reader.open(options.inputPath)) {
+        fprintf(stderr, "Error opening %s\n", options.inputPath);
+        return 1;
+    }
+    if (!reader.readInt(nVertexs) || !reader.readInt(nEdges)) {
+        fprintf(stderr, "Error reading nVertexs and nEdges\n");
+        return 1;
+    }
+    if (nVertexs < 0 || nEdges < 0) {
+        fprintf(stderr, "Invalid nVertexs and nEdges: %d %d\n", nVertexs, nEdges);
+        return 1;
+    }
 
-    int i = 1;
-    int j = 1;
-    int nEdgesForest = 0;
+    string path;
+    if (options.convertPath != nullptr) {
+        path = options.convertPath;
+    } else {
+        const char *directory = getenv("TMPDIR");
+        path = string(directory != nullptr ? directory : "/tmp") + "/alg1csrXXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) {
+            fprintf(stderr, "Error creating a temporary graph file in %s\n", path.c_str());
+            return 1;
+        }
+        close(fd);
+    }
+    ExternalSortReport io;
+    bool built = buildCSRFileExternal(reader, nVertexs, nEdges, path.c_str(), options.memoryBudget, io);
+    timer.lap(BUILD);
+    fprintf(stderr, "External sort: %llu runs, %llu intermediate merge passes, %.1f MB of runs written, %.1f MB read back, %.1f MB of graph file written\n",
+            (unsigned long long)io.runs, (unsigned long long)io.mergePasses, io.runBytesWritten / 1e6, io.runBytesRead / 1e6,
+            io.graphBytesWritten / 1e6);
+    if (!built || options.convertPath != nullptr) {
+        if (!built && options.convertPath == nullptr) unlink(path.c_str());
+        return built ? 0 : 1;
+    }
 
-    // Output clusters
-    set<set<int>>::iterator itr1;
-    set<int>::iterator itr;
-    for(itr1 = clusters.begin(); itr1 != clusters.end(); itr1++) {
-        printf("%d %lu ", nVertexs+i, itr1->size());
-
-        itr = itr1->begin(); 
-        while (itr != itr1->end()) {
-            if(links.find(*itr) != links.end()) {
-                set<int> elemForest;
-                elemForest.insert(nVertexs+i);
-                elemForest.insert(*itr);
-                forest.insert(elemForest);
-                nEdgesForest++;
-            }
-            if(j == (int)itr1->size()) printf("%d\n", *itr);
-            else printf("%d ", *itr);
-            j++;
-            itr++;
+    CSRFile file;
+    bool opened = file.open(path.c_str());
+    unlink(path.c_str());
+    if (!opened) {
+        return 1;
+    }
+    CSRGraph graph = {file.offsets(), file.targets(), file.edges()};
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    ClusterFinder finder;
+    finder.reset(nVertexs, nEdges, true, false, false);
+    finder.run(graph, nVertexs, nullptr);
+    getrusage(RUSAGE_SELF, &after);
+    timer.lap(CLUSTERS);
+    fprintf(stderr, "DFS: %.1f MB of graph file mapped, %ld major page faults\n", file.bytes() / 1e6, after.ru_majflt - before.ru_majflt);
+
+    Writer writer;
+    const vector<uint32_t> &order = finder.sortClusters(nVertexs);
+    timer.lap(SORT);
+    printResult(writer, finder, nVertexs, order);
+    writer.flush();
+    timer.lap(OUTPUT);
+
+    if (options.timing) {
+        timer.report();
+    }
+    if (options.stats) {
+        RunStats stats;
+        stats.add(finder, nVertexs, nEdges);
+        stats.addCounters(finder.counters);
+        stats.report(timer);
+    }
+    return 0;
+}
+
+// One graph of a batch: its edges as read and its formatted output. Slots are reused for
+// the following graphs, keeping the memory of both vectors.
+struct BatchGraph {
+    int nVertexs;
+    int nEdges;
+    vector<uint32_t> endpoints;
+    vector<char> output;
+};
+
+// Buffers owned by one batch worker, reused for every graph it solves
+struct BatchWorker {
+    ClusterFinder finder;
+    CSRStorage<uint32_t> graph;
+    RunStats stats;
+};
+
+void solveBatchGraph(BatchWorker &worker, BatchGraph &instance, OutputMode mode, bool withStats, ThreadPool *enginePool) {
+    worker.finder.reset(instance.nVertexs, instance.nEdges, mode != LABELS, mode == BRIDGES);
+    buildCSR<uint32_t>(worker.graph, instance.nVertexs, instance.endpoints);
+    worker.finder.run(worker.graph.view(), instance.nVertexs, enginePool);
+    if (withStats) {
+        worker.stats.add(worker.finder, instance.nVertexs, instance.nEdges);
+    }
+
+    instance.output.clear();
+    BufferWriter writer(instance.output);
+    if (mode == LABELS) {
+        printLabels(writer, worker.finder, instance.nEdges);
+    } else {
+        printResult(writer, worker.finder, instance.nVertexs, worker.finder.sortClusters(instance.nVertexs));
+        if (mode == BRIDGES) {
+            printBridges(writer, worker.finder, instance.nVertexs, instance.nEdges);
         }
-        j = 1;
-        i++;
     }
+    writer.writeChar('\n'); // A blank line ends the output of every graph
+}
 
-    // Output forest
-    printf("%d %d\n", nClusters+(int)links.size(), nEdgesForest);
-    for(itr1 = forest.begin(); itr1 != forest.end(); itr1++) {
-        printf("%d %d\n", *(itr1->begin()), *(itr1->rbegin()));
+// Reads graphs until the end of the input and prints the result of each one followed by a
+// blank line. Graphs are read a window at a time; the graphs of a window are independent, so
+// they are solved by the workers of the pool in any order and printed in input order after it.
+// With --stats, reading is timed as the parse phase, solving as the clusters phase and writing
+// as the output phase.
+template <class Reader, class Writer>
+int runBatch(const Options &options) {
+    PhaseTimer timer;
+    int nThreads = options.nThreads;
+    Reader reader;
+    if (!reader.open(options.inputPath)) {
+        fprintf(stderr, "Error opening %s\n", options.inputPath);
+        return 1;
     }
 
-    return 0;
+    ThreadPool pool(options.nWorkers);
+    ThreadPool engine(max(nThreads, 1));
+    ThreadPool *enginePool = nThreads > 0 ? &engine : nullptr;
+
+    vector<BatchWorker> workers(pool.size());
+    vector<BatchGraph> window(4 * pool.size());
+    Writer writer;
+    bool failed = false;
+    for (int first = 0; !failed;) {
+        size_t count = 0;
+        while (count < window.size()) {
+            BatchGraph &instance = window[count];
+            if (!reader.readInt(instance.nVertexs)) break;
+            if (!reader.readInt(instance.nEdges) || !readEdges(reader, instance.nVertexs, instance.nEdges, instance.endpoints)) {
+                fprintf(stderr, "Error reading graph %d\n", first + (int)count + 1);
+                failed = true;
+                break;
+            }
+            count++;
+        }
+        timer.lap(PARSE);
+        if (count == 0) break;
+
+        pool.parallelFor(count, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                solveBatchGraph(workers[worker], window[i], options.mode, options.stats, enginePool);
+            }
+        }, 1);
+        timer.lap(CLUSTERS);
+        for (size_t i = 0; i < count; i++) {
+            writer.writeBytes(window[i].output.data(), window[i].output.size());
+        }
+        writer.flush();
+        timer.lap(OUTPUT);
+        first += (int)count;
+    }
+
+    if (options.stats) {
+        RunStats stats;
+        for (const BatchWorker &worker : workers) {
+            stats.merge(worker.stats);
+            stats.addCounters(worker.finder.counters);
+        }
+        stats.report(timer);
+    }
+    return failed ? 1 : 0;
 }
 
+int main(int argc, char *argv[]) {
+    Options options;
+
+    // -d prints articulation points, clusters and forest (default), -l prints only the cluster of each edge.
+    // -f reads and writes through memory buffers instead of scanf/printf; -i reads the graph from a file instead of stdin.
+    // -p finds the clusters with the parallel Tarjan-Vishkin algorithm on the given number of threads.
+    // -s keeps reading edges after the graph and prints what each one changes in the clusters and links.
+    // -q reads separation queries after the graph and prints only their answers.
+    // -e also prints the bridges and the 2-edge-connected components, found by the same DFS.
+    // -b reads graphs until the end of the input and prints each result followed by a blank line;
+    // -j solves the graphs of a batch on the given number of threads.
+    // -c writes the graph read from the text input to a binary graph file; -m maps such a file instead of reading text.
+    // -t prints the time of each phase on stderr: parse, build, clusters, sort, output (ms).
+    // -M sorts the edges externally with the given budget in MB and runs the DFS over the graph file
+    // with O(vertices) memory; only the default output, and -c to just write the graph file.
+    // -r renames the vertices in bfs, rcm (reverse Cuthill-McKee) or degree order before the search, for
+    // cache locality; the output is the same as without it. Not with -l, -e, -b or -M, whose output or
+    // reading depends on the order.
+    // --stats prints the phase times and the counters of the DFS on stderr as one JSON object.
+    enum { STATS_OPTION = 256 };
+    static const struct option longOptions[] = {
+        {"stats", no_argument, nullptr, STATS_OPTION},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "dlfi:p:sqebj:c:m:M:r:t", longOptions, nullptr)) != -1) {
+        switch (option) {
+        case 'd':
+            options.mode = RESULT;
+            break;
+        case 'l':
+            options.mode = LABELS;
+            break;
+        case 'f':
+            options.fastIO = true;
+            break;
+        case 'i':
+            options.inputPath = optarg;
+            break;
+        case 's':
+            options.mode = STREAM;
+            break;
+        case 'q':
+            options.mode = QUERIES;
+            break;
+        case 'e':
+            options.mode = BRIDGES;
+            break;
+        case 'b':
+            options.batch = true;
+            break;
+        case 'c':
+            options.convertPath = optarg;
+            break;
+        case 'm':
+            options.graphPath = optarg;
+            break;
+        case 't':
+            options.timing = true;
+            break;
+        case 'r':
+            if (strcmp(optarg, "bfs") == 0) {
+                options.order = BFS_ORDER;
+            } else if (strcmp(optarg, "rcm") == 0) {
+                options.order = RCM_ORDER;
+            } else if (strcmp(optarg, "degree") == 0) {
+                options.order = DEGREE_ORDER;
+            } else {
+                fprintf(stderr, "Invalid vertex order: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'M':
+            if (atoi(optarg) < 1) {
+                fprintf(stderr, "Invalid memory budget: %s\n", optarg);
+                return 1;
+            }
+            options.memoryBudget = (size_t)atoi(optarg) << 20;
+            break;
+        case STATS_OPTION:
+            options.stats = true;
+            break;
+        case 'p':
+            options.nThreads = atoi(optarg);
+            if (options.nThreads < 1) {
+                fprintf(stderr, "Invalid number of threads: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'j':
+            options.nWorkers = atoi(optarg);
+            if (options.nWorkers < 1) {
+                fprintf(stderr, "Invalid number of threads: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d | -l | -s | -q | -e | -b [-j workers]] [-f] [-i input | -m graph] [-c graph] [-p threads] [-M megabytes] [-r bfs | rcm | degree] [-t] [--stats] < input\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.batch && (options.mode == STREAM || options.mode == QUERIES)) {
+        fprintf(stderr, "-b cannot be combined with -s or -q\n");
+        return 1;
+    }
+    if (options.batch && (options.graphPath != nullptr || options.convertPath != nullptr)) {
+        fprintf(stderr, "-b reads text graphs and cannot be combined with -m or -c\n");
+        return 1;
+    }
+    if (options.mode == BRIDGES && options.nThreads > 0) {
+        fprintf(stderr, "-e needs the DFS and cannot be combined with -p\n");
+        return 1;
+    }
+    if (options.batch && options.nWorkers > 1 && options.nThreads > 0) {
+        fprintf(stderr, "-j and -p cannot be combined\n");
+        return 1;
+    }
+
+    if (options.memoryBudget > 0 && (options.mode != RESULT || options.batch || options.graphPath != nullptr || options.nThreads > 0)) {
+        fprintf(stderr, "-M only prints the default output of a text graph and cannot be combined with -l, -s, -q, -e, -b, -m or -p\n");
+        return 1;
+    }
+
+    if (options.order != INPUT_ORDER && (options.mode == LABELS || options.mode == BRIDGES || options.batch || options.memoryBudget > 0)) {
+        fprintf(stderr, "-r cannot be combined with -l, -e, -b or -M\n");
+        return 1;
+    }
+
+    if (options.memoryBudget > 0) {
+        if (options.fastIO) {
+            return runSemiExternal<FastReader, FastWriter>(options);
+        }
+        return runSemiExternal<StdioReader, StdioWriter>(options);
+    }
+    if (options.batch) {
+        if (options.fastIO) {
+            return runBatch<FastReader, FastWriter>(options);
+        }
+        return runBatch<StdioReader, StdioWriter>(options);
+    }
+    if (options.fastIO) {
+        return run<FastReader, FastWriter>(options);
+    }
+    return run<StdioReader, StdioWriter>(options);
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+# Benchmark das buscas do TP2 em masmorras sintéticas de cerca de TAMANHO espaços. Cada masmorra
+# é gerada uma vez e resolvida REPS vezes com --stats em cada busca: o Dijkstra com cada fila
+# (heap, dial e radix), o motor em camadas, sequencial e com 4 threads (paralelo), e o A*; cada
+# execução acrescenta uma linha ao CSV:
+#   rotulo,masmorra,pesomax,busca,espacos,conexoes,turnos,repeticao,busca_ms,insercoes_fila,relaxacoes,expansoes
+# O rótulo (por padrão o commit atual) separa as versões ao acompanhar regressões.
+#
+# Uso: executar.sh main gerar tamanho reps csv [rotulo]
+
+if [ $# -lt 5 ]; then
+    echo "Uso: $0 main gerar tamanho reps csv [rotulo]" >&2
+    exit 1
+fi
+MAIN=$1
+GERAR=$2
+TAMANHO=$3
+REPS=$4
+CSV=$5
+ROTULO=${6:-$(git rev-parse --short HEAD 2>/dev/null || echo desconhecido)}
+
+LADO=$(awk -v n="$TAMANHO" 'BEGIN { print int(sqrt(n)) }')
+DADOS=$(mktemp -d)
+trap 'rm -rf "$DADOS"' EXIT
+
+if [ ! -f "$CSV" ]; then
+    echo "rotulo,masmorra,pesomax,busca,espacos,conexoes,turnos,repeticao,busca_ms,insercoes_fila,relaxacoes,expansoes" > "$CSV"
+fi
+
+# Extrai um número do JSON de --stats
+campo() {
+    sed -n "s/.*\"$1\":\([0-9.]*\).*/\1/p"
+}
+
+bench() {
+    NOME=$1
+    PESO=$2
+    shift 2
+    "$GERAR" "$@" > "$DADOS/$NOME.txt" || exit 1
+    CONTAGENS=$(head -n 1 "$DADOS/$NOME.txt" | awk '{ print $1 "," $2 "," $4 }')
+    for BUSCA in heap dial radix camadas paralelo astar; do
+        case "$BUSCA" in
+            camadas | astar) OPCOES="--motor $BUSCA" ;;
+            paralelo) OPCOES="--motor camadas --threads 4" ;;
+            *) OPCOES="--fila $BUSCA" ;;
+        esac
+        for REP in $(seq 1 "$REPS"); do
+            STATS=$("$MAIN" --stats $OPCOES < "$DADOS/$NOME.txt" 2>&1 > /dev/null) || exit 1
+            TEMPO=$(echo "$STATS" | campo busca)
+            INSERCOES=$(echo "$STATS" | campo insercoes_fila)
+            RELAXACOES=$(echo "$STATS" | campo relaxacoes)
+            EXPANSOES=$(echo "$STATS" | campo expansoes)
+            echo "$ROTULO,$NOME,$PESO,$BUSCA,$CONTAGENS,$REP,$TEMPO,$INSERCOES,$RELAXACOES,$EXPANSOES" | tee -a "$CSV"
+        done
+    done
+}
+
+bench grade 10 grade "$LADO" "$LADO" 10 "$((LADO / 10))" "$((2 * LADO))" 1
+bench grade 1000 grade "$LADO" "$LADO" 1000 "$((LADO / 10))" "$((2 * LADO))" 1
+bench aleatorio 10 aleatorio "$TAMANHO" "$((4 * TAMANHO))" 10 "$((LADO / 10))" 100 1
+bench aleatorio 100000 aleatorio "$TAMANHO" "$((4 * TAMANHO))" 100000 "$((LADO / 10))" 100 1
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+// Masmorras sintéticas para o benchmark, escritas na saída padrão no formato de entrada do TP2.
+// Os pesos são sorteados entre 1 e pesoMax, e cada turno dá pesoMax recursos:
+//   grade linhas colunas pesoMax monstros turnos semente
+//       uma grade com conexões nos dois sentidos entre vizinhos; o último espaço é o canto oposto
+//   aleatorio n m pesoMax monstros turnos semente
+//       um caminho 1-2-...-n, para que o último espaço seja alcançável, e mais m - (n - 1)
+//       conexões entre espaços sorteados
+// Os monstros começam em espaços sorteados diferentes do inicial.
+
+typedef vector<tuple<int, int, int>> Conexoes;
+
+void grade(Conexoes& conexoes, int linhas, int colunas, uniform_int_distribution<int>& peso, mt19937_64& aleatorio) {
+    for (int l = 0; l < linhas; ++l) {
+        for (int c = 0; c < colunas; ++c) {
+            int espaco = l * colunas + c + 1;
+            if (c + 1 < colunas) {
+                conexoes.emplace_back(espaco, espaco + 1, peso(aleatorio));
+                conexoes.emplace_back(espaco + 1, espaco, peso(aleatorio));
+            }
+            if (l + 1 < linhas) {
+                conexoes.emplace_back(espaco, espaco + colunas, peso(aleatorio));
+                conexoes.emplace_back(espaco + colunas, espaco, peso(aleatorio));
+            }
+        }
+    }
+}
+
+void aleatorio(Conexoes& conexoes, int n, int m, uniform_int_distribution<int>& peso, mt19937_64& gerador) {
+    uniform_int_distribution<int> espaco(1, n);
+    for (int i = 1; i < n; ++i) {
+        conexoes.emplace_back(i, i + 1, peso(gerador));
+    }
+    while ((int)conexoes.size() < m) {
+        int de = espaco(gerador), para = espaco(gerador);
+        if (de != para) conexoes.emplace_back(de, para, peso(gerador));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    auto argumento = [&](int i) { return i < argc ? atoi(argv[i]) : 0; };
+    const char* tipo = argc > 1 ? argv[1] : "";
+
+    int n = 0, pesoMax = 0, monstros = 0, turnos = 0;
+    Conexoes conexoes;
+    mt19937_64 gerador;
+    if (strcmp(tipo, "grade") == 0 && argc == 8 && argumento(2) > 0 && argumento(3) > 0) {
+        n = argumento(2) * argumento(3);
+        pesoMax = argumento(4), monstros = argumento(5), turnos = argumento(6);
+        gerador.seed(argumento(7));
+    } else if (strcmp(tipo, "aleatorio") == 0 && argc == 8 && argumento(2) > 0 && argumento(3) >= argumento(2) - 1) {
+        n = argumento(2);
+        pesoMax = argumento(4), monstros = argumento(5), turnos = argumento(6);
+        gerador.seed(argumento(7));
+    }
+    if (n == 0 || pesoMax < 1 || monstros < 0 || turnos < 1 || (monstros > 0 && n < 2)) {
+        fprintf(stderr, "Uso: %s grade linhas colunas pesoMax monstros turnos semente | "
+                "aleatorio n m pesoMax monstros turnos semente\n", argv[0]);
+        return 1;
+    }
+
+    uniform_int_distribution<int> peso(1, pesoMax);
+    if (tipo[0] == 'g') {
+        grade(conexoes, argumento(2), argumento(3), peso, gerador);
+    } else {
+        aleatorio(conexoes, n, argumento(3), peso, gerador);
+    }
+
+    string saida = to_string(n) + " " + to_string(conexoes.size()) + " " + to_string(monstros) + " " +
+                   to_string(turnos) + " " + to_string(pesoMax) + "\n";
+    uniform_int_distribution<int> espacoMonstro(2, max(n, 2));
+    for (int i = 0; i < monstros; ++i) {
+        saida += to_string(espacoMonstro(gerador)) + (i + 1 == monstros ? "" : " ");
+    }
+    saida += "\n";
+    for (auto& [de, para, p] : conexoes) {
+        saida += to_string(de) + " " + to_string(para) + " " + to_string(p) + "\n";
+    }
+    fwrite(saida.data(), 1, saida.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef ESTADOS_HPP
+#define ESTADOS_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Acima deste número de estados (espaços x turnos) a tabela deixa de ser densa: com 9 bytes por
+// estado nas três tabelas do Dijkstra, o limite fica em torno de 600 MB.
+const size_t LIMITE_ESTADOS_DENSOS = size_t(1) << 26;
+
+/**
+ * Valor associado a cada estado (espaço, turno) do grafo expandido no tempo. Quando cabe no
+ * limite, a tabela é um vetor denso indexado por espaço * numTurnos + turno, e cada acesso é uma
+ * leitura de memória; acima dele, um unordered_map com a mesma chave guarda só os estados
+ * tocados. Estados nunca escritos valem `vazio`.
+ */
+template <class T>
+class TabelaEstados {
+public:
+    /**
+     * Prepara a tabela para numEspacos espaços e turnos 0..numTurnos-1, todos vazios.
+     */
+    void iniciar(int numEspacos, int numTurnos, T valorVazio) {
+        turnos = numTurnos;
+        vazio = valorVazio;
+        size_t total = (size_t)numEspacos * numTurnos;
+        densa = total <= LIMITE_ESTADOS_DENSOS;
+        valores.assign(densa ? total : 0, vazio);
+        esparsos.clear();
+    }
+
+    bool ehDensa() const {
+        return densa;
+    }
+
+    // Valor do estado, sem criá-lo.
+    T ler(int espaco, int turno) const {
+        size_t chave = indice(espaco, turno);
+        if (densa) return valores[chave];
+        auto it = esparsos.find(chave);
+        return it == esparsos.end() ? vazio : it->second;
+    }
+
+    // Referência ao valor do estado, que passa a existir na tabela esparsa.
+    T& operator()(int espaco, int turno) {
+        size_t chave = indice(espaco, turno);
+        if (densa) return valores[chave];
+        return esparsos.emplace(chave, vazio).first->second;
+    }
+
+    /**
+     * Chama f(espaco, turno, valor) para cada estado não vazio. Na tabela densa a ordem é a de
+     * espaço e depois turno; na esparsa não há ordem definida.
+     */
+    template <class F>
+    void paraCada(F f) const {
+        if (densa) {
+            for (size_t chave = 0; chave < valores.size(); ++chave) {
+                if (valores[chave] != vazio) f((int)(chave / turnos), (int)(chave % turnos), valores[chave]);
+            }
+        } else {
+            for (auto& [chave, valor] : esparsos) {
+                if (valor != vazio) f((int)(chave / turnos), (int)(chave % turnos), valor);
+            }
+        }
+    }
+
+private:
+    size_t turnos = 1;
+    T vazio = T();
+    bool densa = true;
+    std::vector<T> valores;
+    std::unordered_map<size_t, T> esparsos;
+
+    size_t indice(int espaco, int turno) const {
+        return (size_t)espaco * turnos + turno;
+    }
+};
+
+#endif
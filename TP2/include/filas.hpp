@@ -0,0 +1,147 @@
+#ifndef FILAS_HPP
+#define FILAS_HPP
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+/**
+ * Estado na fila do Dijkstra. Sai primeiro o de menor custo; entre custos iguais, o de mais
+ * recurso, depois o de maior espaço (da entrada) e depois o de maior turno, a ordem da tupla
+ * (-custo, recurso, espaço, turno) na priority_queue original.
+ */
+struct EntradaFila {
+    int custo;
+    int recurso;
+    int espaco;
+    int turno;
+};
+
+// Comparador das priority_queue: a sai depois de b.
+struct SaiDepois {
+    bool operator()(const EntradaFila& a, const EntradaFila& b) const {
+        if (a.custo != b.custo) return a.custo > b.custo;
+        if (a.recurso != b.recurso) return a.recurso < b.recurso;
+        if (a.espaco != b.espaco) return a.espaco < b.espaco;
+        return a.turno < b.turno;
+    }
+};
+
+typedef std::priority_queue<EntradaFila, std::vector<EntradaFila>, SaiDepois> HeapEntradas;
+
+// Heap binário com todas as entradas, que aceita custos em qualquer ordem.
+class FilaHeap {
+public:
+    void inserir(const EntradaFila& entrada) {
+        heap.push(entrada);
+    }
+
+    bool vazia() const {
+        return heap.empty();
+    }
+
+    EntradaFila retirar() {
+        EntradaFila entrada = heap.top();
+        heap.pop();
+        return entrada;
+    }
+
+private:
+    HeapEntradas heap;
+};
+
+/**
+ * Fila de Dial: com pesos entre 0 e pesoMaximo, as entradas pendentes têm custos entre o atual
+ * e o atual + pesoMaximo, então pesoMaximo + 1 baldes circulares guardam um custo cada. Só os
+ * empates de um mesmo custo passam por um heap, o do balde.
+ * Os custos inseridos não podem ser menores que o último retirado.
+ */
+class FilaDial {
+public:
+    explicit FilaDial(int pesoMaximo) : baldes(pesoMaximo + 1) {}
+
+    void inserir(const EntradaFila& entrada) {
+        baldes[entrada.custo % baldes.size()].push(entrada);
+        ++tamanho;
+    }
+
+    bool vazia() const {
+        return tamanho == 0;
+    }
+
+    EntradaFila retirar() {
+        while (baldes[atual % baldes.size()].empty()) ++atual;
+        HeapEntradas& balde = baldes[atual % baldes.size()];
+        EntradaFila entrada = balde.top();
+        balde.pop();
+        --tamanho;
+        return entrada;
+    }
+
+private:
+    std::vector<HeapEntradas> baldes;
+    size_t atual = 0;       // Custo do balde de onde saiu a última entrada.
+    size_t tamanho = 0;
+};
+
+/**
+ * Radix heap: a entrada de custo c fica no balde do bit mais alto em que c difere do último custo
+ * retirado, e o balde 0 guarda as de custo igual a ele, em um heap para os empates. Quando o
+ * balde 0 esvazia, o primeiro balde não vazio é redistribuído em torno do seu menor custo, então
+ * cada entrada desce no máximo 32 vezes, sem limite para os pesos.
+ * Os custos inseridos não podem ser menores que o último retirado.
+ */
+class FilaRadix {
+public:
+    void inserir(const EntradaFila& entrada) {
+        int indice = balde(entrada.custo);
+        if (indice == 0) {
+            empatados.push(entrada);
+        } else {
+            baldes[indice].push_back(entrada);
+        }
+        ++tamanho;
+    }
+
+    bool vazia() const {
+        return tamanho == 0;
+    }
+
+    EntradaFila retirar() {
+        if (empatados.empty()) {
+            int indice = 1;
+            while (baldes[indice].empty()) ++indice;
+            ultimo = baldes[indice][0].custo;
+            for (const EntradaFila& entrada : baldes[indice]) {
+                if (entrada.custo < ultimo) ultimo = entrada.custo;
+            }
+            for (const EntradaFila& entrada : baldes[indice]) {
+                int novo = balde(entrada.custo);
+                if (novo == 0) {
+                    empatados.push(entrada);
+                } else {
+                    baldes[novo].push_back(entrada);
+                }
+            }
+            baldes[indice].clear();
+        }
+        EntradaFila entrada = empatados.top();
+        empatados.pop();
+        --tamanho;
+        return entrada;
+    }
+
+private:
+    HeapEntradas empatados;                     // Balde 0.
+    std::vector<EntradaFila> baldes[33];
+    int ultimo = 0;
+    size_t tamanho = 0;
+
+    // Número de bits da diferença entre o custo e o último retirado; 0 se são iguais.
+    int balde(int custo) const {
+        uint32_t diferenca = (uint32_t)custo ^ (uint32_t)ultimo;
+        return diferenca == 0 ? 0 : 32 - __builtin_clz(diferenca);
+    }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef OCUPACAO_HPP
+#define OCUPACAO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/**
+ * Estados (espaço, turno) bloqueados pelos monstros. Há dois tipos de bloqueio:
+ *  - pontuais, dos trajetos: a lista ordenada dos turnos em que algum monstro passa por cada
+ *    espaço, vazia nos espaços fora dos trajetos;
+ *  - permanentes, do espaço onde um monstro fica até o fim: um intervalo de turnos por espaço.
+ * A memória é a dos bloqueios pontuais mais O(espaços), sem depender do número de turnos. Cada
+ * consulta compara o turno com o intervalo e faz uma busca binária na lista do espaço, que só
+ * passa de um turno quando vários monstros passam por ele.
+ */
+class Ocupacao {
+public:
+    /**
+     * Prepara a estrutura para numEspacos espaços e turnos 0..numTurnos-1, sem bloqueios.
+     * Bloqueios pontuais em turnos fora desse intervalo são descartados, porque nunca são consultados.
+     */
+    void iniciar(int numEspacos, int numTurnos) {
+        espacos = numEspacos;
+        turnos = numTurnos;
+        pontuais.assign(numEspacos, std::vector<int>());
+        inicioIntervalo.assign(numEspacos, SEM_INTERVALO);
+        fimIntervalo.assign(numEspacos, -1);
+    }
+
+    // Bloqueia o espaço só no turno dado.
+    void bloquear(int espaco, int turno) {
+        if (turno < 0 || turno >= turnos) return;
+        std::vector<int>& lista = pontuais[espaco];
+        auto posicao = std::lower_bound(lista.begin(), lista.end(), turno);
+        if (posicao == lista.end() || *posicao != turno) lista.insert(posicao, turno);
+    }
+
+    /**
+     * Bloqueia o espaço nos turnos de..ate. Cada espaço guarda um só intervalo, então os intervalos
+     * de um mesmo espaço devem se sobrepor, como os que terminam todos no último turno.
+     */
+    void bloquearIntervalo(int espaco, int de, int ate) {
+        inicioIntervalo[espaco] = std::min(inicioIntervalo[espaco], de);
+        fimIntervalo[espaco] = std::max(fimIntervalo[espaco], ate);
+    }
+
+    bool bloqueado(int espaco, int turno) const {
+        if (turno >= inicioIntervalo[espaco] && turno <= fimIntervalo[espaco]) return true;
+        const std::vector<int>& lista = pontuais[espaco];
+        return !lista.empty() && std::binary_search(lista.begin(), lista.end(), turno);
+    }
+
+    // Memória usada pelas listas e pelos intervalos.
+    size_t bytes() const {
+        size_t total = (size_t)espacos * (sizeof(std::vector<int>) + 2 * sizeof(int));
+        for (const std::vector<int>& lista : pontuais) {
+            total += lista.capacity() * sizeof(int);
+        }
+        return total;
+    }
+
+private:
+    static constexpr int SEM_INTERVALO = std::numeric_limits<int>::max();
+
+    int espacos = 0;
+    int turnos = 0;
+    std::vector<std::vector<int>> pontuais; // Turnos dos bloqueios pontuais de cada espaço, em ordem crescente.
+    std::vector<int> inicioIntervalo;       // Bloqueio permanente de cada espaço; vazio se o início passa do fim.
+    std::vector<int> fimIntervalo;
+};
+
+#endif
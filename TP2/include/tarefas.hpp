@@ -0,0 +1,104 @@
+#ifndef TAREFAS_HPP
+#define TAREFAS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Threads fixas que executam laços paralelos. A thread que chama paraCadaBloco trabalha como a
+ * thread 0, então um grupo de uma thread executa tudo sem sincronização.
+ */
+class Tarefas {
+public:
+    explicit Tarefas(int numThreads) {
+        for (int thread = 1; thread < numThreads; ++thread) {
+            threads.emplace_back([this, thread] { executar(thread); });
+        }
+    }
+
+    ~Tarefas() {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            parando = true;
+        }
+        acordar.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    int tamanho() const {
+        return (int)threads.size() + 1;
+    }
+
+    /**
+     * Chama corpo(inicio, fim, thread) em blocos de [0, n) até cobrir todo o intervalo e só retorna
+     * depois do último. Os blocos saem de um contador compartilhado: a thread que termina o seu
+     * pega o próximo, então nenhuma fica parada enquanto sobra trabalho.
+     */
+    template<class Corpo>
+    void paraCadaBloco(size_t n, Corpo corpo, size_t blocoMinimo = 256) {
+        if (n == 0) return;
+        size_t bloco = std::max(blocoMinimo, n / (8 * (size_t)tamanho()) + 1);
+        if (threads.empty() || n <= bloco) {
+            corpo((size_t)0, n, 0);
+            return;
+        }
+
+        std::atomic<size_t> proximo(0);
+        auto trabalho = [&](int thread) {
+            for (;;) {
+                size_t inicio = proximo.fetch_add(bloco);
+                if (inicio >= n) break;
+                corpo(inicio, std::min(n, inicio + bloco), thread);
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            tarefa = trabalho;
+            ativas = (int)threads.size();
+            geracao++;
+        }
+        acordar.notify_all();
+        trabalho(0);
+
+        std::unique_lock<std::mutex> trava(mutex);
+        terminou.wait(trava, [this] { return ativas == 0; });
+        tarefa = nullptr;
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable acordar, terminou;
+    std::function<void(int)> tarefa;
+    unsigned long geracao = 0;  // Laços já distribuídos; cada thread espera um novo.
+    int ativas = 0;             // Threads que ainda não terminaram o laço atual.
+    bool parando = false;
+
+    void executar(int thread) {
+        unsigned long vista = 0;
+        for (;;) {
+            std::function<void(int)> atual;
+            {
+                std::unique_lock<std::mutex> trava(mutex);
+                acordar.wait(trava, [&] { return parando || geracao != vista; });
+                if (parando) return;
+                vista = geracao;
+                atual = tarefa;
+            }
+            atual(thread);
+            {
+                std::lock_guard<std::mutex> trava(mutex);
+                if (--ativas == 0) terminou.notify_one();
+            }
+        }
+    }
+};
+
+#endif
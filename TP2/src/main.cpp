@@ -2,28 +2,201 @@
 #include <vector>
 #include <algorithm>
 #include <queue>
-#include <map>
-#include <set>
-#include <tuple>
 #include <limits>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "estados.hpp"
+#include "filas.hpp"
+#include "ocupacao.hpp"
+#include "tarefas.hpp"
 
 using namespace std;
 
 const int INF = numeric_limits<int>::max();
 
-// Variáveis globais
-int numEspacos, numConexoes, numMonstros, maxTurnos, recursosTurno;
+// Variáveis globais. As do mapa só são escritas antes das buscas; as de cada cenário (monstros,
+// turnos, recursos e o estado das buscas) são thread_local, para que o modo --lote resolva
+// cenários diferentes ao mesmo tempo (veja resolverLote).
+int numEspacos, numConexoes;
+thread_local int numMonstros, maxTurnos, recursosTurno;
 vector<vector<pair<int, int>>> adjList;     // Lista de adjacência para armazenar os pesos e conexões entre espaços.
 vector<vector<int>> adjListInversa;         // Lista de adjacência inversa para uso na busca em largura.
-vector<vector<int>> trajetosMonstros;       // Armazena os trajetos dos monstros.
-set<pair<int, int>> bloqueios;              // Conjunto de espaços e turnos bloqueados pelos monstros.
+thread_local vector<vector<int>> trajetosMonstros;  // Armazena os trajetos dos monstros.
+thread_local Ocupacao bloqueios;                    // Espaços e turnos bloqueados pelos monstros.
 
 vector<int> antecessor;
 vector<int> distBFS;
 
-map<pair<int, int>, pair<int, int>> antecessorDijkstra; // Mapa para antecessor no Dijkstra.
-map<pair<int, int>, int> distDijkstra;                  // Mapa para distâncias no Dijkstra.
-map<pair<int, int>, bool> visitado;                     // Mapa para controle de visitados no Dijkstra.
+// Estados (espaço, turno) do Dijkstra; o motor em camadas usa só os antecessores. O antecessor de
+// um estado no turno t está sempre no turno t - 1, então basta guardar o espaço.
+thread_local TabelaEstados<int> antecessorDijkstra;  // Espaço anterior de cada estado; -1 se não alcançado.
+thread_local TabelaEstados<int> distDijkstra;        // Distância de cada estado; INF se não alcançado.
+thread_local TabelaEstados<char> visitado;           // Estados já retirados da fila.
+
+// Limites inferiores do A* até o último espaço (veja calcularEstimativas); INF se ele não é alcançável.
+vector<int> custoAteFim;    // Menor custo, sem monstros nem limite de turnos ou recursos.
+vector<int> passosAteFim;   // Menor número de movimentos.
+
+vector<int> idOriginal;     // Espaço da entrada (0-based) de cada índice interno; identidade sem --ordem.
+vector<int> idInterno;      // Índice interno de cada espaço da entrada.
+
+// Filas de prioridade do Dijkstra (veja filas.hpp).
+enum TipoFila { FILA_HEAP, FILA_DIAL, FILA_RADIX };
+const char* nomesFilas[] = {"heap", "dial", "radix"};
+
+// Motores de busca, escolhidos por --motor.
+enum Motor { MOTOR_DIJKSTRA, MOTOR_CAMADAS, MOTOR_A_ESTRELA };
+const char* nomesMotores[] = {"dijkstra", "camadas", "astar"};
+
+// Fila de Dial só até este peso máximo: são pesoMaximo + 1 baldes, cada um com um heap vazio.
+const int LIMITE_PESO_DIAL = 1 << 16;
+
+// Fases cronometradas pela opção --stats.
+enum Fase { LEITURA, BFS, BLOQUEIOS, BUSCA, SAIDA, NUM_FASES };
+const char* nomesFases[NUM_FASES] = {"leitura", "bfs", "bloqueios", "busca", "saida"};
+
+/**
+ * Tempos das fases e contadores dos laços principais, impressos em JSON na saída de erro pela
+ * opção --stats. Os contadores são sempre atualizados: cada incremento custa muito menos que a
+ * consulta ao mapa ou à fila que ele conta, então a execução sem --stats não fica mais lenta.
+ */
+struct Estatisticas {
+    double tempoFase[NUM_FASES] = {};
+    long long insercoesFila = 0;        // Estados inseridos na fila de prioridade.
+    long long remocoesFila = 0;         // Estados retirados da fila.
+    long long remocoesObsoletas = 0;    // Retiradas de estados já visitados ou além do último turno.
+    long long relaxacoes = 0;           // Arestas examinadas a partir de estados visitados.
+    long long camadas = 0;              // Turnos varridos pelo motor em camadas.
+    long long rotulos = 0;              // Custos (e recursos) atribuídos a estados.
+    long long rotulosDominados = 0;     // Rótulos descartados por um de custo menor ou igual no estado.
+    long long consultasEstados = 0;     // Acessos a distDijkstra, antecessorDijkstra e visitado.
+    long long consultasBloqueios = 0;   // Bloqueios marcados e consultados.
+    TipoFila fila = FILA_HEAP;          // Fila usada pelo Dijkstra.
+    Motor motor = MOTOR_DIJKSTRA;       // Motor usado na busca.
+    long long expansoes = 0;            // Estados expandidos, com as conexões examinadas.
+    int threads = 1;                    // Threads da varredura do motor em camadas.
+    chrono::steady_clock::time_point ultimo = chrono::steady_clock::now();
+
+    // Soma à fase o tempo desde a chamada anterior.
+    void marcar(Fase fase) {
+        chrono::steady_clock::time_point agora = chrono::steady_clock::now();
+        tempoFase[fase] += chrono::duration<double, milli>(agora - ultimo).count();
+        ultimo = agora;
+    }
+
+    void imprimir() const {
+        fprintf(stderr, "{\"fases_ms\":{");
+        for (int fase = 0; fase < NUM_FASES; ++fase) {
+            fprintf(stderr, "%s\"%s\":%.3f", fase == 0 ? "" : ",", nomesFases[fase], tempoFase[fase]);
+        }
+        fprintf(stderr, "},\"insercoes_fila\":%lld,\"remocoes_fila\":%lld,\"remocoes_obsoletas\":%lld,"
+                "\"relaxacoes\":%lld,\"consultas_estados\":%lld,\"consultas_bloqueios\":%lld,\"tabela_densa\":%s,"
+                "\"bytes_bloqueios\":%zu,\"motor\":\"%s\",\"fila\":\"%s\",\"camadas\":%lld,"
+                "\"rotulos\":%lld,\"rotulos_dominados\":%lld,\"expansoes\":%lld,\"threads\":%d}\n",
+                insercoesFila, remocoesFila, remocoesObsoletas, relaxacoes, consultasEstados, consultasBloqueios,
+                antecessorDijkstra.ehDensa() ? "true" : "false", bloqueios.bytes(),
+                nomesMotores[motor], motor == MOTOR_CAMADAS ? "" : nomesFilas[fila], camadas,
+                rotulos, rotulosDominados, expansoes, threads);
+    }
+};
+thread_local Estatisticas estatisticas;
+
+/**
+ * Calcula a numeração interna dos espaços pedida por --ordem, para que espaços vizinhos fiquem
+ * próximos nos vetores indexados por espaço:
+ *  - "bfs": ordem de visita de uma BFS sem direção a partir do espaço inicial (e dos espaços
+ *    não alcançados, em ordem crescente);
+ *  - "rcm": Cuthill-McKee reverso, uma BFS que começa no espaço de menor grau e visita os vizinhos
+ *    em ordem crescente de grau, numerada de trás para frente;
+ *  - "grau": espaços de maior grau primeiro, empates pelo menor índice.
+ * Qualquer outro valor mantém a ordem da entrada.
+ *
+ * @param ordem O nome da ordem.
+ */
+void calcularOrdem(const string& ordem) {
+    idOriginal.resize(numEspacos);
+    for (int i = 0; i < numEspacos; ++i) {
+        idOriginal[i] = i;
+    }
+
+    vector<int> grau(numEspacos, 0);
+    for (int i = 0; i < numEspacos; ++i) {
+        grau[i] = adjList[i].size() - 1 + adjListInversa[i].size();   // Sem a autoconexão.
+    }
+    if (ordem == "grau") {
+        stable_sort(idOriginal.begin(), idOriginal.end(), [&grau](int a, int b) { return grau[a] > grau[b]; });
+    } else if (ordem == "bfs" || ordem == "rcm") {
+        vector<int> origens(idOriginal);
+        if (ordem == "rcm") {
+            stable_sort(origens.begin(), origens.end(), [&grau](int a, int b) { return grau[a] < grau[b]; });
+        }
+        vector<bool> visto(numEspacos, false);
+        vector<int> vizinhos;
+        int fim = 0;
+        for (int origem : origens) {
+            if (visto[origem]) continue;
+            visto[origem] = true;
+            idOriginal[fim++] = origem;
+            for (int inicio = fim - 1; inicio < fim; ++inicio) {
+                int espaco = idOriginal[inicio];
+                vizinhos.clear();
+                for (auto& [adj, peso] : adjList[espaco]) {
+                    if (!visto[adj]) {
+                        visto[adj] = true;
+                        vizinhos.emplace_back(adj);
+                    }
+                }
+                for (auto& adj : adjListInversa[espaco]) {
+                    if (!visto[adj]) {
+                        visto[adj] = true;
+                        vizinhos.emplace_back(adj);
+                    }
+                }
+                if (ordem == "rcm") {
+                    stable_sort(vizinhos.begin(), vizinhos.end(), [&grau](int a, int b) { return grau[a] < grau[b]; });
+                }
+                for (int adj : vizinhos) {
+                    idOriginal[fim++] = adj;
+                }
+            }
+        }
+        if (ordem == "rcm") {
+            reverse(idOriginal.begin(), idOriginal.end());
+        }
+    }
+
+    idInterno.resize(numEspacos);
+    for (int i = 0; i < numEspacos; ++i) {
+        idInterno[idOriginal[i]] = i;
+    }
+}
+
+/**
+ * Renumera as listas de adjacência com os índices internos, mantendo a ordem das conexões de
+ * cada espaço. Os desempates que dependem do índice de um espaço usam sempre idOriginal, então
+ * a saída é a mesma com qualquer ordem.
+ */
+void reordenarEspacos() {
+    vector<vector<pair<int, int>>> novaAdjList(numEspacos);
+    vector<vector<int>> novaAdjListInversa(numEspacos);
+    for (int i = 0; i < numEspacos; ++i) {
+        int espaco = idOriginal[i];
+        for (auto& [adj, peso] : adjList[espaco]) {
+            novaAdjList[i].emplace_back(idInterno[adj], peso);
+        }
+        for (auto& adj : adjListInversa[espaco]) {
+            novaAdjListInversa[i].emplace_back(idInterno[adj]);
+        }
+    }
+    adjList.swap(novaAdjList);
+    adjListInversa.swap(novaAdjListInversa);
+}
 
 /**
  * Realiza a busca em largura (BFS) para determinar caminhos mínimos do vértice inicial para todos os outros.
@@ -46,7 +219,7 @@ void bfs(int inicio = 0) {
                     distBFS[adj] = distBFS[vertice] + 1;
                     antecessor[adj] = vertice;
                     fila.push(adj);
-                } else if (distBFS[vertice] + 1 == distBFS[adj] && vertice < antecessor[adj]) {
+                } else if (distBFS[vertice] + 1 == distBFS[adj] && idOriginal[vertice] < idOriginal[antecessor[adj]]) {
                     antecessor[adj] = vertice;
                 }
             }
@@ -54,70 +227,812 @@ void bfs(int inicio = 0) {
     }
 }
 
+// Maior peso das conexões, contando as autoconexões de peso 1; -1 se algum peso é negativo.
+int pesoMaximo() {
+    int maximo = 0;
+    for (auto& conexoes : adjList) {
+        for (auto& [adj, peso] : conexoes) {
+            if (peso < 0) return -1;
+            maximo = max(maximo, peso);
+        }
+    }
+    return maximo;
+}
+
+// Menor peso das conexões, contando as autoconexões de peso 1.
+int pesoMinimo() {
+    int minimo = 1;
+    for (auto& conexoes : adjList) {
+        for (auto& [adj, peso] : conexoes) {
+            minimo = min(minimo, peso);
+        }
+    }
+    return minimo;
+}
+
+// Estado em que a busca termina: o do último espaço ou, se ele não é alcançado, o estado escolhido
+// entre os alcançados, de onde sai o caminho impresso.
+struct EstadoFinal {
+    bool chegou;
+    int espaco;
+    int turno;
+    int custo;
+};
+
+/**
+ * Escolhe a fila do Dijkstra pelo nome dado em --fila. As filas monótonas (Dial e radix heap)
+ * exigem pesos não negativos; com um peso negativo, ou se o nome não é conhecido, fica o heap.
+ * Sem nome, a escolha é a de Dial quando o maior peso cabe em LIMITE_PESO_DIAL e a de radix heap
+ * nos demais casos, que é também o que "dial" vira acima do limite. Nas masmorras de make bench
+ * as duas retiram os estados em 0,3 a 0,8 do tempo do heap.
+ *
+ * @param nome O nome da fila, ou vazio.
+ */
+TipoFila escolherFila(const string& nome) {
+    int peso = pesoMaximo();
+    if (peso < 0) return FILA_HEAP;
+    if (nome.empty()) return peso <= LIMITE_PESO_DIAL ? FILA_DIAL : FILA_RADIX;
+    if (nome == "dial" && peso <= LIMITE_PESO_DIAL) return FILA_DIAL;
+    if (nome == "dial" || nome == "radix") return FILA_RADIX;
+    return FILA_HEAP;
+}
+
+/**
+ * Recurso que sobra no estado (espaço, turno) alcançado com o custo dado. Cada turno dá
+ * recursosTurno e cada movimento gasta o próprio peso, que é também o que ele soma ao custo, então
+ * o recurso é sempre turno * recursosTurno - custo, qualquer que seja o caminho.
+ *
+ * Por isso não é preciso guardar vários rótulos (custo, recurso) por estado: no mesmo estado, o
+ * rótulo de menor custo tem o maior recurso e domina os demais, e os movimentos que ele permite
+ * incluem os de qualquer outro. O menor custo de cada estado, guardado pelos dois motores, já é a
+ * fronteira de Pareto inteira; um rótulo oferecido a um estado que já tem custo menor ou igual é
+ * descartado como dominado (rotulosDominados em --stats).
+ */
+long long recursoDoEstado(int turno, int custo) {
+    return (long long)turno * recursosTurno - custo;
+}
+
+/**
+ * Calcula os limites inferiores do A* (veja dijkstra): custoAteFim com um Dijkstra a partir do
+ * último espaço sobre as conexões invertidas, e passosAteFim com uma BFS sobre as mesmas conexões.
+ * Os monstros, os turnos e os recursos são ignorados, então nenhum caminho real custa menos ou
+ * anda menos, e pela desigualdade triangular as estimativas são consistentes.
+ */
+void calcularEstimativas() {
+    int fim = idInterno[numEspacos - 1];
+    vector<vector<pair<int, int>>> inversa(numEspacos);
+    for (int vertice = 0; vertice < numEspacos; ++vertice) {
+        for (auto& [adj, peso] : adjList[vertice]) {
+            if (adj != vertice) inversa[adj].emplace_back(vertice, peso);
+        }
+    }
+
+    custoAteFim.assign(numEspacos, INF);
+    custoAteFim[fim] = 0;
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+    heap.push({0, fim});
+    while (!heap.empty()) {
+        auto [custo, vertice] = heap.top();
+        heap.pop();
+        if (custo > custoAteFim[vertice]) continue;
+        for (auto& [adj, peso] : inversa[vertice]) {
+            if (custo + peso < custoAteFim[adj]) {
+                custoAteFim[adj] = custo + peso;
+                heap.push({custoAteFim[adj], adj});
+            }
+        }
+    }
+
+    passosAteFim.assign(numEspacos, INF);
+    passosAteFim[fim] = 0;
+    queue<int> fila;
+    fila.push(fim);
+    while (!fila.empty()) {
+        int vertice = fila.front();
+        fila.pop();
+        for (auto& [adj, peso] : inversa[vertice]) {
+            if (passosAteFim[adj] == INF) {
+                passosAteFim[adj] = passosAteFim[vertice] + 1;
+                fila.push(adj);
+            }
+        }
+    }
+}
+
 /**
  * Executa o algoritmo de Dijkstra no grafo para encontrar o caminho de custo mínimo.
- * 
+ *
+ * Com aEstrela, a busca é um A*: a chave de cada estado é o custo mais custoAteFim do espaço, ou
+ * INF se os passos até o último espaço não cabem nos turnos que restam (veja calcularEstimativas).
+ * As estimativas são consistentes, então as chaves retiradas nunca diminuem e cada estado é
+ * retirado já com o menor custo; os estados que não podem levar ao último espaço com custo menor
+ * que o encontrado nunca são expandidos. Para o resultado ser o mesmo do Dijkstra:
+ *  - entre chaves iguais sai antes o estado de menor custo, e só depois vêm os desempates do
+ *    Dijkstra; com pesos positivos, os antecessores de um estado saem antes dele;
+ *  - um antecessor que dá o mesmo custo substitui o atual se o Dijkstra o retiraria antes.
+ * Isso exige pesos positivos e recursosTurno não negativo (veja main).
+ *
+ * @param fila A fila de prioridade, vazia (veja filas.hpp); todas retiram os estados na mesma ordem.
+ *             No A*, as chaves podem saltar mais que o maior peso, então a fila de Dial não serve.
  * @param inicio O vértice inicial do caminho.
- * @return Um par contendo o último vértice do caminho e o turno em que ele foi alcançado.
+ * @param aEstrela Se a busca usa as estimativas de calcularEstimativas, já calculadas.
+ * @return O estado do último espaço ou, se ele não foi alcançado, o de maior turno, depois menor
+ *         distância e depois menor espaço da entrada.
  */
-pair<int, int> dijkstra(int inicio = 0) {
-    distDijkstra[{inicio, 0}] = 0;
-    antecessorDijkstra[{inicio, 0}] = {inicio, 0};
+template <class Fila>
+EstadoFinal dijkstra(Fila& fila, int inicio = 0, bool aEstrela = false) {
+    // Variáveis thread_local lidas por referência: cada acesso direto passa pela verificação da
+    // inicialização da variável na thread
+    Estatisticas& estatisticas = ::estatisticas;
+    const Ocupacao& bloqueios = ::bloqueios;
+    TabelaEstados<int>& distDijkstra = ::distDijkstra;
+    TabelaEstados<int>& antecessorDijkstra = ::antecessorDijkstra;
+    TabelaEstados<char>& visitado = ::visitado;
+    distDijkstra.iniciar(numEspacos, maxTurnos + 1, INF);
+    antecessorDijkstra.iniciar(numEspacos, maxTurnos + 1, -1);
+    visitado.iniciar(numEspacos, maxTurnos + 1, 0);
+    distDijkstra(inicio, 0) = 0;
+    antecessorDijkstra(inicio, 0) = inicio;
+    estatisticas.consultasEstados += 2;
+    estatisticas.rotulos++;
 
-    priority_queue<tuple<int, int, int, int>> pq;   // Fila de prioridade para Dijkstra com peso negativo para min heap.
-    pq.push({0, 0, inicio, 0});
+    // Chave e desempate de um estado na fila. No Dijkstra, custo e recurso.
+    auto chave = [&](int vertice, int turno, int custo) {
+        if (!aEstrela) return custo;
+        if (custoAteFim[vertice] == INF || turno + passosAteFim[vertice] > maxTurnos) return INF;
+        return (int)min<long long>(INF, (long long)custo + custoAteFim[vertice]);
+    };
+    auto desempate = [&](int turno, int custo) {
+        return aEstrela ? -custo : (int)recursoDoEstado(turno, custo);
+    };
 
-    while (!pq.empty()) {
-        auto [custo, recurso, vertice, turno] = pq.top();
-        pq.pop();
+    fila.inserir({chave(inicio, 0, 0), 0, idOriginal[inicio], 0});  // A fila guarda o espaço original, que desempata.
+    estatisticas.insercoesFila++;
 
-        if (vertice == numEspacos - 1) {    // Verifica se chegou no último espaço.
-            return {vertice, turno};
+    while (!fila.vazia()) {
+        EntradaFila entrada = fila.retirar();
+        int verticeOriginal = entrada.espaco, turno = entrada.turno;
+        int vertice = idInterno[verticeOriginal];
+        estatisticas.remocoesFila++;
+
+        // A entrada mais nova de um estado sai antes das obsoletas, então custo é o da entrada.
+        estatisticas.consultasEstados++;
+        int custo = distDijkstra.ler(vertice, turno);
+        if (verticeOriginal == numEspacos - 1) {    // Verifica se chegou no último espaço.
+            return {true, vertice, turno, custo};
         }
-        if (visitado[{vertice, turno}] || turno + 1 > maxTurnos) {  // Pula iterações desnecessárias.
+        estatisticas.consultasEstados++;
+        if (visitado.ler(vertice, turno) || turno + 1 > maxTurnos) {  // Pula iterações desnecessárias.
+            estatisticas.remocoesObsoletas++;
             continue;
         }
 
-        visitado[{vertice, turno}] = true;
-        custo *= -1;
-        recurso += recursosTurno;
+        visitado(vertice, turno) = 1;
+        estatisticas.consultasEstados++;
+        estatisticas.expansoes++;
+        long long recurso = recursoDoEstado(turno, custo) + recursosTurno;
         turno++;
 
         for (auto& [adj, peso] : adjList[vertice]) {
-            if (!bloqueios.count({adj, turno - 1}) && !bloqueios.count({adj, turno})) {
-                if (!distDijkstra.count({adj, turno})) {
-                    distDijkstra[{adj, turno}] = INF;
+            estatisticas.relaxacoes++;
+            estatisticas.consultasBloqueios++;
+            if (bloqueios.bloqueado(adj, turno - 1)) continue;
+            estatisticas.consultasBloqueios++;
+            if (bloqueios.bloqueado(adj, turno)) continue;
+
+            if (recurso < peso) continue;
+
+            estatisticas.consultasEstados++;
+            int& distAdj = distDijkstra(adj, turno);
+            if (custo + peso < distAdj) {
+                estatisticas.rotulos++;
+                distAdj = custo + peso;
+                antecessorDijkstra(adj, turno) = vertice;
+                fila.inserir({chave(adj, turno, distAdj), desempate(turno, distAdj), idOriginal[adj], turno});
+                estatisticas.consultasEstados++;
+                estatisticas.insercoesFila++;
+            } else if (aEstrela && custo + peso == distAdj && !visitado.ler(adj, turno)) {
+                // O Dijkstra fica com o antecessor que retira primeiro: menor custo, depois maior
+                // espaço da entrada (no mesmo turno, custos iguais têm recursos iguais)
+                int atual = antecessorDijkstra.ler(adj, turno);
+                int custoAtual = distDijkstra.ler(atual, turno - 1);
+                estatisticas.consultasEstados += 3;
+                if (custo < custoAtual || (custo == custoAtual && idOriginal[vertice] > idOriginal[atual])) {
+                    antecessorDijkstra(adj, turno) = vertice;
+                    estatisticas.rotulos++;
+                } else {
+                    estatisticas.rotulosDominados++;
+                }
+            } else {
+                estatisticas.rotulosDominados++;
+            }
+        }
+    }
+
+    EstadoFinal final = {false, inicio, 0, 0};
+    distDijkstra.paraCada([&](int vertice, int turno, int dist) {
+        if (turno > final.turno || (turno == final.turno && (dist < final.custo ||
+            (dist == final.custo && idOriginal[vertice] < idOriginal[final.espaco])))) {
+            final = {false, vertice, turno, dist};
+        }
+    });
+    return final;
+}
+
+/**
+ * Camada do motor em camadas: custo e antecessor de cada espaço em um turno, e a lista dos espaços
+ * alcançados nele. O custo dos espaços não alcançados é INF; o recurso sai do custo (veja
+ * recursoDoEstado).
+ */
+struct Camada {
+    vector<int> custo, antecessor, alcancados;
+
+    void iniciar(int n) {
+        custo.assign(n, INF);
+        antecessor.assign(n, -1);
+        alcancados.clear();
+    }
+
+    void limpar() {
+        for (int vertice : alcancados) {
+            custo[vertice] = INF;
+        }
+        alcancados.clear();
+    }
+};
+
+// Estado de uma camada guardada como ponto de controle.
+struct EstadoCamada {
+    int espaco;
+    int custo;
+};
+
+// Pontos de controle do motor em camadas: os estados alcançados nos turnos múltiplos de
+// intervaloPontos, o de índice i no turno i * intervaloPontos. Vazio quando o motor guarda o
+// antecessor de todos os estados.
+thread_local vector<vector<EstadoCamada>> pontosDeControle;
+thread_local int intervaloPontos = 0;
+
+// Contadores de uma thread da varredura paralela, somados às estatísticas no fim de cada camada.
+// Cada um ocupa a sua linha de cache, para que as threads não disputem a mesma.
+struct alignas(64) ContadoresThread {
+    long long expansoes = 0;
+    long long relaxacoes = 0;
+    long long consultasBloqueios = 0;
+    long long rotulos = 0;
+    long long rotulosDominados = 0;
+};
+
+// Palavra dos espaços ainda não alcançados na próxima camada (veja avancarCamadaParalela).
+const uint64_t SEM_ROTULO = numeric_limits<uint64_t>::max();
+
+// Camadas com menos estados que isto são varridas por uma thread só: a ordenação e a barreira
+// custariam mais que a varredura.
+const size_t LIMITE_CAMADA_PARALELA = 4096;
+
+/**
+ * Estado da varredura paralela das camadas, criado por iniciarVarreduraParalela. Sem ele (tarefas
+ * nulo), as camadas são varridas por uma thread só.
+ */
+Tarefas* tarefas = nullptr;
+unique_ptr<atomic<uint64_t>[]> melhorRotulo;    // Custo e antecessor de cada espaço da próxima camada.
+vector<int> ordemCamada;                        // Estados da camada atual na ordem do Dijkstra.
+vector<vector<int>> alcancadosPorThread;        // Espaços que cada thread alcançou primeiro.
+vector<ContadoresThread> contadoresPorThread;
+
+void iniciarVarreduraParalela(Tarefas& grupo) {
+    tarefas = &grupo;
+    melhorRotulo.reset(new atomic<uint64_t>[numEspacos]);
+    for (int i = 0; i < numEspacos; ++i) {
+        melhorRotulo[i].store(SEM_ROTULO, memory_order_relaxed);
+    }
+    alcancadosPorThread.assign(grupo.tamanho(), vector<int>());
+    contadoresPorThread.assign(grupo.tamanho(), ContadoresThread());
+    estatisticas.threads = grupo.tamanho();
+}
+
+// Se o Dijkstra retiraria o estado de u antes do de a, os dois na camada dada: menor custo, depois
+// maior espaço da entrada. Na mesma camada, custos iguais têm recursos iguais.
+bool retiradoAntes(const Camada& camada, int u, int a) {
+    if (camada.custo[u] != camada.custo[a]) return camada.custo[u] < camada.custo[a];
+    return idOriginal[u] > idOriginal[a];
+}
+
+/**
+ * Versão de avancarCamada com as threads de tarefas, com o mesmo resultado. Os estados da camada
+ * atual são ordenados na ordem em que o Dijkstra os retiraria, e as threads dividem essa lista em
+ * blocos. Cada espaço da próxima camada tem uma palavra de 64 bits com o custo nos 32 bits altos e
+ * a posição do antecessor na ordem nos baixos, e cada conexão faz um mínimo atômico (por
+ * compare-and-swap, sem travas) nessa palavra. A menor palavra é a de menor custo e, no empate, a
+ * do antecessor retirado primeiro, o mesmo que a varredura sequencial escolhe, qualquer que seja a
+ * ordem em que as threads chegam. Depois da barreira as palavras são decodificadas na camada.
+ */
+void avancarCamadaParalela(const Camada& atual, Camada& prox, int turno) {
+    // As threads do grupo têm as suas próprias variáveis thread_local, então os bloqueios e os
+    // recursos do cenário são lidos aqui, na thread que chama
+    const Ocupacao& bloqueios = ::bloqueios;
+    long long recursoDoTurno = recursoDoEstado(turno, 0);
+    ordemCamada = atual.alcancados;
+    sort(ordemCamada.begin(), ordemCamada.end(), [&](int u, int a) { return retiradoAntes(atual, u, a); });
+
+    estatisticas.camadas++;
+    tarefas->paraCadaBloco(ordemCamada.size(), [&](size_t de, size_t ate, int thread) {
+        ContadoresThread& contadores = contadoresPorThread[thread];
+        vector<int>& alcancados = alcancadosPorThread[thread];
+        for (size_t posicao = de; posicao < ate; ++posicao) {
+            int vertice = ordemCamada[posicao];
+            if (idOriginal[vertice] == numEspacos - 1) continue;
+            contadores.expansoes++;
+            for (auto& [adj, peso] : adjList[vertice]) {
+                contadores.relaxacoes++;
+                contadores.consultasBloqueios++;
+                if (bloqueios.bloqueado(adj, turno - 1)) continue;
+                contadores.consultasBloqueios++;
+                if (bloqueios.bloqueado(adj, turno)) continue;
+
+                int total = atual.custo[vertice] + peso;
+                if (recursoDoTurno - total < 0) continue;
+
+                uint64_t rotulo = (uint64_t)total << 32 | posicao;
+                uint64_t anterior = melhorRotulo[adj].load(memory_order_relaxed);
+                while (rotulo < anterior &&
+                       !melhorRotulo[adj].compare_exchange_weak(anterior, rotulo, memory_order_relaxed)) {
+                }
+                if (rotulo >= anterior) {
+                    contadores.rotulosDominados++;
+                    continue;
                 }
+                // Só a thread que tira o espaço de SEM_ROTULO o põe na lista.
+                if (anterior == SEM_ROTULO) alcancados.emplace_back(adj);
+                contadores.rotulos++;
+            }
+        }
+    }, 64);
+
+    for (int thread = 0; thread < tarefas->tamanho(); ++thread) {
+        ContadoresThread& contadores = contadoresPorThread[thread];
+        estatisticas.expansoes += contadores.expansoes;
+        estatisticas.relaxacoes += contadores.relaxacoes;
+        estatisticas.consultasBloqueios += contadores.consultasBloqueios;
+        estatisticas.rotulos += contadores.rotulos;
+        estatisticas.rotulosDominados += contadores.rotulosDominados;
+        contadores = ContadoresThread();
+        prox.alcancados.insert(prox.alcancados.end(), alcancadosPorThread[thread].begin(),
+                               alcancadosPorThread[thread].end());
+        alcancadosPorThread[thread].clear();
+    }
+
+    tarefas->paraCadaBloco(prox.alcancados.size(), [&](size_t de, size_t ate, int) {
+        for (size_t i = de; i < ate; ++i) {
+            int vertice = prox.alcancados[i];
+            uint64_t rotulo = melhorRotulo[vertice].load(memory_order_relaxed);
+            prox.custo[vertice] = (int)(rotulo >> 32);
+            prox.antecessor[vertice] = ordemCamada[(uint32_t)rotulo];
+            melhorRotulo[vertice].store(SEM_ROTULO, memory_order_relaxed);
+        }
+    });
+}
+
+/**
+ * Calcula em prox, vazia, a camada do turno a partir da camada atual, do turno anterior. Cada
+ * estado fica com o antecessor que o Dijkstra retiraria primeiro entre os que dão o menor custo:
+ * menor custo, depois mais recurso, depois maior espaço da entrada (veja retiradoAntes). O último
+ * espaço não é expandido. Com --threads, as camadas grandes são varridas por avancarCamadaParalela.
+ */
+void avancarCamada(const Camada& atual, Camada& prox, int turno) {
+    if (tarefas != nullptr && atual.alcancados.size() >= LIMITE_CAMADA_PARALELA) {
+        avancarCamadaParalela(atual, prox, turno);
+        return;
+    }
+    // Referências às variáveis thread_local, como em dijkstra
+    Estatisticas& estatisticas = ::estatisticas;
+    const Ocupacao& bloqueios = ::bloqueios;
+
+
+    estatisticas.camadas++;
+    for (int vertice : atual.alcancados) {
+        if (idOriginal[vertice] == numEspacos - 1) continue;
+        estatisticas.expansoes++;
+        for (auto& [adj, peso] : adjList[vertice]) {
+            estatisticas.relaxacoes++;
+            estatisticas.consultasBloqueios++;
+            if (bloqueios.bloqueado(adj, turno - 1)) continue;
+            estatisticas.consultasBloqueios++;
+            if (bloqueios.bloqueado(adj, turno)) continue;
+
+            int total = atual.custo[vertice] + peso;
+            if (recursoDoEstado(turno, total) < 0) continue;
+
+            if (prox.custo[adj] == INF) {
+                prox.alcancados.emplace_back(adj);
+            } else if (total > prox.custo[adj] ||
+                       (total == prox.custo[adj] && !retiradoAntes(atual, vertice, prox.antecessor[adj]))) {
+                estatisticas.rotulosDominados++;
+                continue;
+            }
+            estatisticas.rotulos++;
+            prox.custo[adj] = total;
+            prox.antecessor[adj] = vertice;
+        }
+    }
+}
+
+// Guarda a camada como o próximo ponto de controle.
+void guardarPonto(const Camada& camada) {
+    pontosDeControle.emplace_back();
+    for (int vertice : camada.alcancados) {
+        pontosDeControle.back().push_back({vertice, camada.custo[vertice]});
+    }
+}
+
+/**
+ * Motor alternativo ao Dijkstra. Toda transição avança um turno, então os estados formam um grafo
+ * em camadas sem ciclos, e cada camada pode ser calculada a partir da anterior, sem fila (veja
+ * avancarCamada): só ficam na memória duas camadas e o que é preciso para imprimir o caminho.
+ *
+ * Para o caminho há dois modos. Com intervalo 0, o antecessor de cada estado vai para
+ * antecessorDijkstra, O(V·T) de memória. Com intervalo k, só as camadas dos turnos múltiplos de k
+ * são guardadas, e recomporCaminho recalcula os trechos entre elas: com k perto de √T a memória
+ * fica em O(V·√T), ao custo de varrer de novo as camadas até o estado final.
+ *
+ * O resultado é o do Dijkstra quando todos os pesos são positivos (veja main): o estado final é o
+ * primeiro do último espaço que o Dijkstra retiraria (menor custo, depois mais recurso, depois
+ * maior turno) ou, sem caminho, o mesmo estado escolhido por ele. Com peso 0 isso falha, porque o
+ * Dijkstra pode retirar o último espaço antes de alcançar outro estado dele de mesmo custo. Com
+ * pesos positivos, um estado do turno t custa pelo menos t, então a varredura para quando nenhum
+ * estado da camada custa menos que o último espaço já alcançado.
+ *
+ * @param inicio O vértice inicial do caminho.
+ * @param intervalo A distância em turnos entre os pontos de controle, ou 0 para guardar todos
+ *                  os antecessores.
+ * @return O estado final, como o de dijkstra.
+ */
+EstadoFinal camadas(int inicio, int intervalo) {
+    Camada atual, prox;
+    atual.iniciar(numEspacos);
+    prox.iniciar(numEspacos);
+    atual.custo[inicio] = 0;
+    atual.alcancados.emplace_back(inicio);
+    estatisticas.rotulos++;
+
+    intervaloPontos = intervalo;
+    pontosDeControle.clear();
+    if (intervalo == 0) {
+        antecessorDijkstra.iniciar(numEspacos, maxTurnos + 1, -1);
+        antecessorDijkstra(inicio, 0) = inicio;
+        estatisticas.consultasEstados++;
+    } else {
+        guardarPonto(atual);
+    }
+    if (idOriginal[inicio] == numEspacos - 1) {
+        return {true, inicio, 0, 0};
+    }
+
+    EstadoFinal final = {false, inicio, 0, 0};
+    for (int turno = 1; turno <= maxTurnos && !atual.alcancados.empty(); ++turno) {
+        avancarCamada(atual, prox, turno);
+        swap(atual, prox);
+        prox.limpar();
+        if (intervalo == 0) {
+            for (int vertice : atual.alcancados) {
+                antecessorDijkstra(vertice, turno) = atual.antecessor[vertice];
+                estatisticas.consultasEstados++;
+            }
+        } else if (turno % intervalo == 0) {
+            guardarPonto(atual);
+        }
 
-                if (recurso >= peso && distDijkstra[{vertice, turno - 1}] + peso < distDijkstra[{adj, turno}]) {
-                    antecessorDijkstra[{adj, turno}] = {vertice, turno - 1};
-                    distDijkstra[{adj, turno}] = distDijkstra[{vertice, turno - 1}] + peso;
-                    pq.push({-distDijkstra[{adj, turno}], recurso - peso, adj, turno});
+        int menorCusto = INF;
+        for (int vertice : atual.alcancados) {
+            int custo = atual.custo[vertice];
+            menorCusto = min(menorCusto, custo);
+            if (idOriginal[vertice] == numEspacos - 1) {
+                // Empates de custo e recurso ficam com o maior turno, o atual.
+                if (!final.chegou || custo < final.custo || (custo == final.custo &&
+                    recursoDoEstado(turno, custo) >= recursoDoEstado(final.turno, final.custo))) {
+                    final = {true, vertice, turno, custo};
                 }
+            } else if (!final.chegou && (turno > final.turno || custo < final.custo ||
+                       (custo == final.custo && idOriginal[vertice] < idOriginal[final.espaco]))) {
+                final = {false, vertice, turno, custo};
             }
         }
+        if (final.chegou && menorCusto >= final.custo) break;
     }
+    return final;
+}
 
-    return {-1, -1};    // Retorna -1 se não encontrar um caminho válido.
+/**
+ * Recompõe o caminho até o estado (espaco, turno) a partir dos pontos de controle do motor em
+ * camadas. Do último ponto antes do turno, as camadas do trecho são recalculadas com seus
+ * antecessores, que levam o caminho de volta até o ponto; o trecho anterior parte do estado
+ * alcançado ali. Só os antecessores de um trecho, O(V·intervalo), ficam na memória.
+ *
+ * @return Os espaços do caminho, do turno 0 ao turno dado.
+ */
+vector<int> recomporCaminho(int espaco, int turno) {
+    vector<int> caminho = {espaco};
+    Camada atual, prox;
+    atual.iniciar(numEspacos);
+    prox.iniciar(numEspacos);
+    TabelaEstados<int> antecessores;
+    antecessores.iniciar(numEspacos, intervaloPontos + 1, -1);
+
+    while (turno > 0) {
+        int inicioTrecho = (turno - 1) / intervaloPontos * intervaloPontos;
+        atual.limpar();
+        for (const EstadoCamada& estado : pontosDeControle[inicioTrecho / intervaloPontos]) {
+            atual.custo[estado.espaco] = estado.custo;
+            atual.alcancados.emplace_back(estado.espaco);
+        }
+        for (int t = inicioTrecho + 1; t <= turno; ++t) {
+            avancarCamada(atual, prox, t);
+            swap(atual, prox);
+            prox.limpar();
+            for (int vertice : atual.alcancados) {
+                antecessores(vertice, t - inicioTrecho) = atual.antecessor[vertice];
+            }
+        }
+        for (; turno > inicioTrecho; --turno) {
+            espaco = antecessores.ler(espaco, turno - inicioTrecho);
+            caminho.emplace_back(espaco);
+        }
+    }
+    reverse(caminho.begin(), caminho.end());
+    return caminho;
 }
 
-// Função para imprimir o caminho
-void imprimirCaminho(pair<int, int> pos) {
-    printf("%d %d\n", distDijkstra[pos], pos.second);
+// Os espaços do caminho até o estado (espaco, turno), do turno 0 ao turno dado, por antecessorDijkstra.
+vector<int> caminhoPorAntecessores(int espaco, int turno) {
+    vector<int> caminho = {espaco};
+    for (; turno > 0; --turno) {
+        espaco = antecessorDijkstra.ler(espaco, turno);
+        caminho.emplace_back(espaco);
+    }
+    reverse(caminho.begin(), caminho.end());
+    return caminho;
+}
 
-    vector<int> caminho;
-    while (pos != antecessorDijkstra[pos]) {
-        caminho.emplace_back(pos.first);
-        pos = antecessorDijkstra[pos];
+// Escreve na saída o custo, o turno e o caminho, com os espaços da entrada
+void escreverCaminho(string& saida, const EstadoFinal& final, const vector<int>& caminho) {
+    saida += to_string(final.custo) + " " + to_string(final.turno) + "\n";
+    for (size_t i = 0; i < caminho.size(); ++i) {
+        saida += to_string(idOriginal[caminho[i]] + 1);
+        saida += i + 1 == caminho.size() ? '\n' : ' ';
     }
-    caminho.emplace_back(0);
+}
+
+// Opções da busca, as mesmas para todos os cenários de um lote (veja main).
+struct OpcoesBusca {
+    string motor;           // Nome dado em --motor.
+    TipoFila fila;          // Fila do Dijkstra, de escolherFila.
+    bool forcarPontos;      // --pontos.
+    int pesoMinimo;         // Menor e maior peso das conexões, calculados uma vez por mapa.
+    int pesoMaximo;
+};
+
+/**
+ * Resolve um cenário sobre o mapa já lido: marca os trajetos dos monstros que partem dos espaços
+ * dados, busca o caminho com maxTurnos e recursosTurno da thread e devolve o texto da saída. Do
+ * mapa só lê as listas de adjacência, a árvore da BFS e as estimativas do A*, então cenários
+ * diferentes podem ser resolvidos ao mesmo tempo em threads diferentes.
+ *
+ * @param indicesMonstros Os espaços iniciais dos monstros, com os índices internos.
+ * @param inicio O vértice inicial do caminho.
+ * @param opcoes As opções da busca.
+ * @return As linhas da saída do cenário.
+ */
+string resolverCenario(const vector<int>& indicesMonstros, int inicio, const OpcoesBusca& opcoes) {
+    numMonstros = indicesMonstros.size();
+    trajetosMonstros.assign(numMonstros, vector<int>());
 
-    for (int i = caminho.size() - 1; i >= 0; --i) {
-        printf("%d%c", caminho[i] + 1, i == 0 ? '\n' : ' ');
+    // Os turnos consultados vão até maxTurnos + 1, pelo estado extra da saída sem caminho.
+    bloqueios.iniciar(numEspacos, maxTurnos + 2);
+    for (int i = 0; i < numMonstros; ++i) {
+        int turnoBloqueio = 0;
+        if (antecessor[indicesMonstros[i]] != INF) {
+            int atual = indicesMonstros[i];
+            while (true) {
+                trajetosMonstros[i].emplace_back(atual);
+                bloqueios.bloquear(atual, turnoBloqueio++);
+                estatisticas.consultasBloqueios++;
+                if (atual == inicio) break;
+                atual = antecessor[atual];
+            }
+
+            bloqueios.bloquearIntervalo(inicio, turnoBloqueio, maxTurnos);
+            estatisticas.consultasBloqueios++;
+        } else {
+            trajetosMonstros[i].emplace_back(indicesMonstros[i]);
+            bloqueios.bloquearIntervalo(indicesMonstros[i], 0, maxTurnos);
+            estatisticas.consultasBloqueios++;
+        }
+    }
+    estatisticas.marcar(BLOQUEIOS);
+
+    // O motor em camadas e o A* só dão o resultado do Dijkstra com pesos positivos, e o A* também
+    // com recursosTurno não negativo; nos outros casos fica o Dijkstra.
+    EstadoFinal resultado;
+    estatisticas.fila = opcoes.fila;
+    estatisticas.motor = MOTOR_DIJKSTRA;
+    intervaloPontos = 0;
+    if (opcoes.motor == "camadas" && opcoes.pesoMinimo > 0) {
+        estatisticas.motor = MOTOR_CAMADAS;
+    } else if (opcoes.motor == "astar" && opcoes.pesoMinimo > 0 && recursosTurno >= 0) {
+        estatisticas.motor = MOTOR_A_ESTRELA;
     }
+    if (estatisticas.motor == MOTOR_CAMADAS) {
+        // Pontos de controle a cada √T turnos quando a tabela de antecessores não seria densa
+        int intervalo = 0;
+        if (opcoes.forcarPontos || (size_t)numEspacos * (maxTurnos + 1) > LIMITE_ESTADOS_DENSOS) {
+            intervalo = 1;
+            while ((long long)(intervalo + 1) * (intervalo + 1) <= maxTurnos) ++intervalo;
+        }
+        resultado = camadas(inicio, intervalo);
+    } else if (estatisticas.motor == MOTOR_A_ESTRELA) {
+        // As estimativas só dependem do mapa; o lote as calcula antes de distribuir os cenários
+        if (custoAteFim.empty()) {
+            calcularEstimativas();
+        }
+        if (estatisticas.fila == FILA_HEAP) {
+            FilaHeap filaHeap;
+            resultado = dijkstra(filaHeap, inicio, true);
+        } else {
+            estatisticas.fila = FILA_RADIX;
+            FilaRadix filaRadix;
+            resultado = dijkstra(filaRadix, inicio, true);
+        }
+    } else if (estatisticas.fila == FILA_DIAL) {
+        FilaDial filaDial(opcoes.pesoMaximo);
+        resultado = dijkstra(filaDial, inicio);
+    } else if (estatisticas.fila == FILA_RADIX) {
+        FilaRadix filaRadix;
+        resultado = dijkstra(filaRadix, inicio);
+    } else {
+        FilaHeap filaHeap;
+        resultado = dijkstra(filaHeap, inicio);
+    }
+    estatisticas.marcar(BUSCA);
+
+    string saida = resultado.chegou ? "1\n" : "0\n";
+    for (auto& trajeto : trajetosMonstros) {
+        saida += to_string(trajeto.size()) + " ";
+        for (size_t i = 0; i < trajeto.size(); ++i) {
+            saida += to_string(idOriginal[trajeto[i]] + 1);
+            saida += i == trajeto.size() - 1 ? '\n' : ' ';
+        }
+    }
+
+    vector<int> caminho = intervaloPontos > 0 ? recomporCaminho(resultado.espaco, resultado.turno)
+                                              : caminhoPorAntecessores(resultado.espaco, resultado.turno);
+    // Sem caminho, o estado escolhido avança um turno parado se o espaço estiver bloqueado nele
+    if (!resultado.chegou && bloqueios.bloqueado(resultado.espaco, resultado.turno + 1)) {
+        caminho.emplace_back(resultado.espaco);
+        resultado.custo++;
+        resultado.turno++;
+    }
+    escreverCaminho(saida, resultado, caminho);
+    return saida;
+}
+
+// Cenário do modo --lote: os monstros (espaços da entrada, 0-based), os turnos e os recursos.
+struct Cenario {
+    int maxTurnos;
+    int recursosTurno;
+    vector<int> monstros;
+};
+
+// Cenários resolvidos por thread antes de cada escrita da saída do lote.
+const size_t CENARIOS_POR_THREAD = 64;
+
+/**
+ * Modo --lote: o primeiro cenário é o da entrada normal, e cada linha depois das conexões traz
+ * mais um, no formato "numMonstros maxTurnos recursosTurno monstro1 ... monstroK". O mapa, a
+ * árvore da BFS até o espaço inicial e as estimativas do A* são calculados uma vez; os cenários
+ * são divididos entre as threads do grupo, cada uma com as suas variáveis thread_local, e as
+ * saídas são escritas na ordem da entrada, iguais às de executar o programa uma vez por cenário.
+ *
+ * @param primeiro O cenário lido no início da entrada.
+ * @param inicio O vértice inicial do caminho.
+ * @param opcoes As opções da busca.
+ * @param grupo As threads que resolvem os cenários.
+ * @param imprimirEstatisticas Se imprime os tempos do lote em JSON na saída de erro.
+ * @return O código de saída do programa.
+ */
+int resolverLote(const Cenario& primeiro, int inicio, const OpcoesBusca& opcoes, Tarefas& grupo,
+                 bool imprimirEstatisticas) {
+    vector<Cenario> cenarios = {primeiro};
+    Cenario cenario;
+    int quantidade;
+    while (scanf("%d", &quantidade) == 1) {
+        if (quantidade < 0 || scanf("%d %d", &cenario.maxTurnos, &cenario.recursosTurno) != 2) {
+            cerr << "Erro na leitura do cenário " << cenarios.size() + 1 << ".\n";
+            return 1;
+        }
+        cenario.monstros.resize(quantidade);
+        for (auto& indice : cenario.monstros) {
+            if (scanf("%d", &indice) != 1) {
+                cerr << "Erro na leitura dos monstros do cenário " << cenarios.size() + 1 << ".\n";
+                return 1;
+            }
+            --indice;
+        }
+        cenarios.emplace_back(cenario);
+    }
+    estatisticas.marcar(LEITURA);
+
+    chrono::steady_clock::time_point comeco = chrono::steady_clock::now();
+    if (opcoes.motor == "astar" && opcoes.pesoMinimo > 0) {
+        calcularEstimativas();
+    }
+    size_t janela = CENARIOS_POR_THREAD * grupo.tamanho();
+    vector<string> saidas;
+    for (size_t primeiroJanela = 0; primeiroJanela < cenarios.size(); primeiroJanela += janela) {
+        saidas.assign(min(janela, cenarios.size() - primeiroJanela), string());
+        grupo.paraCadaBloco(saidas.size(), [&](size_t de, size_t ate, int) {
+            vector<int> indicesMonstros;
+            for (size_t i = de; i < ate; ++i) {
+                const Cenario& atual = cenarios[primeiroJanela + i];
+                maxTurnos = atual.maxTurnos;
+                recursosTurno = atual.recursosTurno;
+                indicesMonstros.clear();
+                for (int indice : atual.monstros) {
+                    indicesMonstros.emplace_back(idInterno[indice]);
+                }
+                saidas[i] = resolverCenario(indicesMonstros, inicio, opcoes);
+            }
+        }, 1);
+        for (const string& saida : saidas) {
+            fwrite(saida.data(), 1, saida.size(), stdout);
+        }
+    }
+
+    if (imprimirEstatisticas) {
+        fflush(stdout);
+        fprintf(stderr, "{\"fases_ms\":{\"leitura\":%.3f,\"bfs\":%.3f,\"cenarios\":%.3f},\"cenarios\":%zu,\"threads\":%d}\n",
+                estatisticas.tempoFase[LEITURA], estatisticas.tempoFase[BFS],
+                chrono::duration<double, milli>(chrono::steady_clock::now() - comeco).count(),
+                cenarios.size(), grupo.tamanho());
+    }
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --stats imprime os tempos das fases e os contadores em JSON na saída de erro.
+    // --ordem bfs|rcm|grau renumera os espaços antes das buscas (veja calcularOrdem); a saída não muda.
+    // --fila heap|dial|radix escolhe a fila do Dijkstra (veja escolherFila); a saída não muda.
+    // --motor camadas troca o Dijkstra pela varredura por turnos (veja camadas); a saída não muda.
+    // --motor astar usa o A* com as estimativas de calcularEstimativas (veja dijkstra); a saída não muda.
+    // --pontos faz o motor em camadas guardar só pontos de controle mesmo quando todos os
+    // antecessores cabem na tabela densa.
+    // --threads N varre cada camada do motor em camadas com N threads (veja avancarCamadaParalela);
+    // a saída não muda.
+    // --lote resolve vários cenários sobre o mesmo mapa (veja resolverLote); com --threads, as N
+    // threads dividem os cenários, e cada camada é varrida por uma só.
+    // As demais opções são ignoradas.
+    estatisticas.marcar(LEITURA);   // Cria as estatísticas da thread, que contam o tempo a partir daqui.
+    bool imprimirEstatisticas = false, lote = false;
+    OpcoesBusca opcoes = {"", FILA_HEAP, false, 1, 0};
+    string ordem, fila;
+    int numThreads = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            imprimirEstatisticas = true;
+        } else if (strcmp(argv[i], "--ordem") == 0 && i + 1 < argc) {
+            ordem = argv[++i];
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            fila = argv[++i];
+        } else if (strcmp(argv[i], "--motor") == 0 && i + 1 < argc) {
+            opcoes.motor = argv[++i];
+        } else if (strcmp(argv[i], "--pontos") == 0) {
+            opcoes.forcarPontos = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--lote") == 0) {
+            lote = true;
+        }
+    }
+
     // Leitura de entrada
     if (scanf("%d %d %d %d %d", &numEspacos, &numConexoes, &numMonstros, &maxTurnos, &recursosTurno) != 5) {
         cerr << "Erro na leitura dos dados iniciais.\n";
@@ -126,7 +1041,6 @@ int main() {
     adjList = vector<vector<pair<int, int>>>(numEspacos);
     adjListInversa = vector<vector<int>>(numEspacos);
     vector<int> indicesMonstros(numMonstros);
-    trajetosMonstros = vector<vector<int>>(numMonstros);
 
     for (auto& indice : indicesMonstros) {
         if (scanf("%d", &indice) != 1) {
@@ -151,61 +1065,38 @@ int main() {
         adjList[de].emplace_back(para, peso);
         adjListInversa[para].emplace_back(de);
     }
-
-    bfs();  // Executa BFS para encontrar trajetos mínimos.
-
-    for (int i = 0; i < numMonstros; ++i) {
-        int turnoBloqueio = 0;
-        if (antecessor[indicesMonstros[i]] != INF) {
-            int atual = indicesMonstros[i];
-            while (true) {
-                trajetosMonstros[i].emplace_back(atual);
-                bloqueios.insert({atual, turnoBloqueio++});
-                if (atual == 0) break;
-                atual = antecessor[atual];
-            }
-
-            for (int turno = turnoBloqueio; turno <= maxTurnos; ++turno) {
-                bloqueios.insert({0, turno});
-            }
-        } else {
-            trajetosMonstros[i].emplace_back(indicesMonstros[i]);
-            for (int turno = 0; turno <= maxTurnos; ++turno) {
-                bloqueios.insert({indicesMonstros[i], turno});
-            }
-        }
+    calcularOrdem(ordem);
+    if (!ordem.empty()) {
+        reordenarEspacos();
     }
+    int inicio = idInterno[0];
+    opcoes.pesoMinimo = pesoMinimo();
+    opcoes.pesoMaximo = pesoMaximo();
+    opcoes.fila = escolherFila(fila);
+    estatisticas.marcar(LEITURA);
 
-    pair<int, int> resultado = dijkstra();
-    printf("%d\n", resultado.first == -1 ? 0 : 1);
+    bfs(inicio);  // Executa BFS para encontrar trajetos mínimos.
+    estatisticas.marcar(BFS);
 
-    for (auto& trajeto : trajetosMonstros) {
-        printf("%zu ", trajeto.size());
-        for (size_t i = 0; i < trajeto.size(); ++i) {
-            printf("%d%c", trajeto[i] + 1, i == trajeto.size() - 1 ? '\n' : ' ');
-        }
+    if (lote) {
+        Tarefas grupo(numThreads);
+        return resolverLote({maxTurnos, recursosTurno, indicesMonstros}, inicio, opcoes, grupo, imprimirEstatisticas);
     }
 
-    if (resultado.first != -1) {
-        imprimirCaminho(resultado);
-    } else {
-        int maxVertice = 0, maxTurno = 0;
-        for (auto& entrada : distDijkstra) {
-            if (entrada.second == INF) continue;
-            if (entrada.first.second > maxTurno || (entrada.first.second == maxTurno && entrada.second < distDijkstra[{maxVertice, maxTurno}])) {
-                maxVertice = entrada.first.first;
-                maxTurno = entrada.first.second;
-            }
-        }
-
-        if (bloqueios.count({maxVertice, maxTurno + 1})) {
-            distDijkstra[{maxVertice, maxTurno + 1}] = distDijkstra[{maxVertice, maxTurno}] + 1;
-            antecessorDijkstra[{maxVertice, maxTurno + 1}] = {maxVertice, maxTurno};
-            maxTurno++;
-        }
-
-        imprimirCaminho({maxVertice, maxTurno});
+    for (auto& indice : indicesMonstros) {
+        indice = idInterno[indice];
+    }
+    Tarefas grupo(opcoes.motor == "camadas" && opcoes.pesoMinimo > 0 ? numThreads : 1);
+    if (grupo.tamanho() > 1) {
+        iniciarVarreduraParalela(grupo);
     }
+    string saida = resolverCenario(indicesMonstros, inicio, opcoes);
+    fwrite(saida.data(), 1, saida.size(), stdout);
+    estatisticas.marcar(SAIDA);
 
+    if (imprimirEstatisticas) {
+        fflush(stdout);
+        estatisticas.imprimir();
+    }
     return 0;
 }
@@ -1,12 +1,13 @@
 #include <iostream>
 #include <vector>
 #include <queue>
-#include <map>
-#include <set>
 #include <tuple>
 #include <limits>
 #include <algorithm>
 
+#include "estados.hpp"
+#include "ocupacao.hpp"
+
 using namespace std;
 
 const int INF = numeric_limits<int>::max();
@@ -17,9 +18,9 @@ public:
     vector<vector<int>> adjListInversa;
     vector<int> antecessor;
     vector<int> distBFS;
-    map<pair<int, int>, pair<int, int>> antecessorDijkstra;
-    map<pair<int, int>, int> distDijkstra;
-    map<pair<int, int>, bool> visitado;
+    TabelaEstados<int> antecessorDijkstra;  // Espaço anterior de cada estado, que está no turno anterior
+    TabelaEstados<int> distDijkstra;
+    TabelaEstados<char> visitado;
 
     Grafo(int numEspacos) {
         adjList.resize(numEspacos);
@@ -49,13 +50,13 @@ public:
         }
     }
 
-    pair<int, int> dijkstra(int inicio, int maxTurnos, int recursosTurno, const set<pair<int, int>>& bloqueios) {
-        distDijkstra.clear();
-        antecessorDijkstra.clear();
-        visitado.clear();
+    pair<int, int> dijkstra(int inicio, int maxTurnos, int recursosTurno, const Ocupacao& bloqueios) {
+        distDijkstra.iniciar(adjList.size(), maxTurnos + 2, INF);
+        antecessorDijkstra.iniciar(adjList.size(), maxTurnos + 2, -1);
+        visitado.iniciar(adjList.size(), maxTurnos + 2, 0);
 
-        distDijkstra[{inicio, 0}] = 0;
-        antecessorDijkstra[{inicio, 0}] = {inicio, 0};
+        distDijkstra(inicio, 0) = 0;
+        antecessorDijkstra(inicio, 0) = inicio;
 
         priority_queue<tuple<int, int, int, int>> pq;
         pq.push({0, 0, inicio, 0});
@@ -67,21 +68,22 @@ public:
             if (vertice == adjList.size() - 1) {
                 return {vertice, turno};
             }
-            if (visitado[{vertice, turno}] || turno + 1 > maxTurnos) {
+            if (visitado.ler(vertice, turno) || turno + 1 > maxTurnos) {
                 continue;
             }
 
-            visitado[{vertice, turno}] = true;
+            visitado(vertice, turno) = 1;
             custo *= -1;
             recurso += recursosTurno;
             turno++;
 
             for (auto& [adj, peso] : adjList[vertice]) {
-                if (!bloqueios.count({adj, turno - 1}) && !bloqueios.count({adj, turno})) {
-                    if (recurso >= peso && custo + peso < distDijkstra[{adj, turno}]) {
-                        distDijkstra[{adj, turno}] = custo + peso;
-                        antecessorDijkstra[{adj, turno}] = {vertice, turno - 1};
-                        pq.push({-distDijkstra[{adj, turno}], recurso - peso, adj, turno});
+                if (!bloqueios.bloqueado(adj, turno - 1) && !bloqueios.bloqueado(adj, turno)) {
+                    int& distAdj = distDijkstra(adj, turno);
+                    if (recurso >= peso && custo + peso < distAdj) {
+                        distAdj = custo + peso;
+                        antecessorDijkstra(adj, turno) = vertice;
+                        pq.push({-distAdj, recurso - peso, adj, turno});
                     }
                 }
             }
@@ -96,7 +98,7 @@ public:
     int numEspacos, numConexoes, numMonstros, maxTurnos, recursosTurno;
     Grafo* grafo;
     vector<vector<int>> trajetosMonstros;
-    set<pair<int, int>> bloqueios;
+    Ocupacao bloqueios;
 
     Jogo(int nEspacos, int nConexoes, int nMonstros, int maxT, int recTurno)
         : numEspacos(nEspacos), numConexoes(nConexoes), numMonstros(nMonstros), maxTurnos(maxT), recursosTurno(recTurno) {
@@ -109,18 +111,17 @@ public:
 
     void processarMonstros(const vector<int>& indicesMonstros) {
         trajetosMonstros.resize(numMonstros);
+        bloqueios.iniciar(numEspacos, maxTurnos + 2);
         for (int i = 0; i < numMonstros; ++i) {
             int atual = indicesMonstros[i];
             int turnoBloqueio = 0;
             while (atual != 0 && grafo->antecessor[atual] != INF) {
                 trajetosMonstros[i].emplace_back(atual);
-                bloqueios.insert({atual, turnoBloqueio++});
+                bloqueios.bloquear(atual, turnoBloqueio++);
                 atual = grafo->antecessor[atual];
             }
             trajetosMonstros[i].emplace_back(0); // Add starting point to path
-            for (int turno = turnoBloqueio; turno <= maxTurnos; ++turno) {
-                bloqueios.insert({0, turno});
-            }
+            bloqueios.bloquearIntervalo(0, turnoBloqueio, maxTurnos);
         }
     }
 
@@ -131,16 +132,16 @@ public:
             return;
         }
 
-        int custoTotal = grafo->distDijkstra[pos]; 
+        int custoTotal = grafo->distDijkstra.ler(pos.first, pos.second);
         int turnosJogados = pos.second;
         printf("%d %d\n", custoTotal, turnosJogados);
 
         vector<int> caminho;
         caminho.push_back(1); 
         
-        while (pos != grafo->antecessorDijkstra[pos]) {
+        while (pos.second > 0) {
             caminho.emplace_back(pos.first + 1); 
-            pos = grafo->antecessorDijkstra[pos];
+            pos = {grafo->antecessorDijkstra.ler(pos.first, pos.second), pos.second - 1};
         }
         reverse(caminho.begin(), caminho.end());
 
@@ -213,19 +214,18 @@ int main() {
     } else {
         // Considera o caso onde não há caminho válido
         // Ajuste adicional para encontrar e imprimir o caminho modificado
-        int maxVertice = 0, maxTurno = 0;
-        for (const auto& entry : jogo.grafo->distDijkstra) {
-            if (entry.second == INF) continue;
-            auto [vertex, turno] = entry.first;
-            if (turno > maxTurno || (turno == maxTurno && entry.second < jogo.grafo->distDijkstra[{maxVertice, maxTurno}])) {
+        int maxVertice = 0, maxTurno = 0, distMax = 0;
+        jogo.grafo->distDijkstra.paraCada([&](int vertex, int turno, int dist) {
+            if (turno > maxTurno || (turno == maxTurno && (dist < distMax || (dist == distMax && vertex < maxVertice)))) {
                 maxVertice = vertex;
                 maxTurno = turno;
+                distMax = dist;
             }
-        }
+        });
 
-        if (jogo.bloqueios.count({maxVertice, maxTurno + 1})) {
-            jogo.grafo->distDijkstra[{maxVertice, maxTurno + 1}] = jogo.grafo->distDijkstra[{maxVertice, maxTurno}] + 1;
-            jogo.grafo->antecessorDijkstra[{maxVertice, maxTurno + 1}] = {maxVertice, maxTurno};
+        if (jogo.bloqueios.bloqueado(maxVertice, maxTurno + 1)) {
+            jogo.grafo->distDijkstra(maxVertice, maxTurno + 1) = distMax + 1;
+            jogo.grafo->antecessorDijkstra(maxVertice, maxTurno + 1) = maxVertice;
             maxTurno++;
         }
 
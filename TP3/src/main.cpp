@@ -1,11 +1,15 @@
 #include <algorithm>
 #include <climits>
+#include <cstdint>
 #include <cstdio>
-#include <list>
-#include <set>
+#include <cstdlib>
 #include <utility>
+#include <unistd.h>
 #include <vector>
 
+#include "fastio.hpp"
+#include "thread_pool.hpp"
+
 using namespace std;
 
 // Class to represent a vertex in the graph
@@ -24,173 +28,554 @@ public:
     }
 };
 
-vector<Vertex> vertices; 
-set<int> links; // Store edge links in a set, as they need to be printed in ascending order
-int nClusters = 0;
+// Graph stored in compressed sparse row form: the vertices adjacent to vertex v (0-based)
+// are targets[offsets[v]] .. targets[offsets[v+1]-1], and edges[k] is the index in the
+// input of the edge stored at position k
+struct CSRGraph {
+    vector<uint32_t> offsets;
+    vector<uint32_t> targets;
+    vector<uint32_t> edges;
+};
+
+const uint32_t NO_EDGE = UINT32_MAX;
 
-typedef pair<int, int> Edge;
+// Edge on the DFS edge stack: the vertex it was traversed from and its position in
+// CSRGraph::targets, which gives both the other endpoint and the edge index
+struct StackedEdge {
+    uint32_t source;
+    uint32_t position;
+};
 
-list<Edge> EdgeList;
-set<set<int>> clusters; // Clusters must be sorted lexicographically. Ou seja, se temos os clusters a = {1, 3, 7} e b = {1, 2, 100}, o cluster b deve ser listado antes do cluster a, e, portanto, possuir um identificador menor.
-set<set<int>> forest;
-typedef set<int> VertexSet;
+// Frame of the explicit DFS stack: the vertex being explored and the position in
+// CSRGraph::targets of the next adjacent vertex to visit. The parent of a frame is the
+// vertex of the frame right below it, so it does not need to be stored.
+struct Frame {
+    uint32_t vertex;
+    uint32_t next;
+};
+
+// State of the search for the articulation points and clusters of one graph. Every buffer
+// is kept between graphs and only cleared by reset, so a process that handles many graphs
+// allocates memory only when a graph is larger than the previous ones.
+class ClusterFinder {
+public:
+    vector<Vertex> vertices;
+    vector<char> isLink; // Whether each vertex is a link (articulation point); scanned in ascending order for the output
+    int nLinks = 0;
+    int nClusters = 0;
+    vector<uint32_t> blockOf; // Cluster of each input edge, numbered from 1 in the order the clusters are found (0 for self-loops)
+
+    // Arena with the vertices of every cluster, in the order the clusters are found: cluster c
+    // (0-based) has the sorted vertices clusterMembers[clusterOffsets[c]] .. clusterMembers[clusterOffsets[c+1]-1]
+    vector<uint32_t> clusterOffsets = vector<uint32_t>(1, 0);
+    vector<uint32_t> clusterMembers;
+
+    vector<uint32_t> forestOffsets, forestClusters, forestPosition; // Scratch buffers of printResult
+
+    // Clears the state for a graph with nVertexs vertices and nEdges edges; when withClusters
+    // is false only blockOf is filled
+    void reset(int nVertexs, int nEdges, bool withClusters);
+
+    // Finds the articulation points and clusters with the DFS
+    void run(const CSRGraph &graph, int nVertexs);
+
+    const vector<uint32_t> &sortClusters(int nVertexs);
+
+private:
+    vector<StackedEdge> edgeStack; // Edges of the clusters still being explored, kept contiguous and reused
+    vector<int> clusterMark; // Last cluster that included each vertex, used to list the vertices of a cluster only once
+    vector<int> clusterVertices; // Vertices of the cluster being popped
+    bool buildClusters = true; // Whether the vertex sets of the clusters are needed, or only blockOf
+    vector<Frame> dfsStack; // Reused across DFS trees, so the traversal depth is limited only by memory
+    vector<uint32_t> order, sorted, counts; // Scratch buffers of sortClusters
+
+    void addLink(int indexVertex);
+    void findClusters(const CSRGraph &graph, uint32_t treeEdge);
+    void countingSortClusters(const vector<uint32_t> &input, vector<uint32_t> &output, int nVertexs, int rank);
+    void finishChild(const CSRGraph &graph, int indexVertex, int parent, int child, uint32_t treeEdge, int children);
+    void dfs(const CSRGraph &graph, int root, int time);
+};
 
-// Function to identify and retrieve clusters in the graph
-void findClusters(int u, int v) {
-    VertexSet clusterVertices;
-    list<Edge> tempEdgeList; // Temporary stack to hold the edges of the current cluster
+void ClusterFinder::reset(int nVertexs, int nEdges, bool withClusters) {
+    vertices.assign(nVertexs, Vertex());
+    isLink.assign(nVertexs, 0);
+    clusterMark.assign(nVertexs, 0);
+    blockOf.assign(nEdges, 0);
+    nLinks = 0;
+    nClusters = 0;
+    buildClusters = withClusters;
+    edgeStack.clear();
+    dfsStack.clear();
+    clusterOffsets.assign(1, 0);
+    clusterMembers.clear();
+}
 
-    // Pop edges from EdgeList until we find the edge that starts the current cluster
-    while (!EdgeList.empty() && (EdgeList.back().first != u || EdgeList.back().second != v)) {
-        tempEdgeList.push_front(EdgeList.back()); // Move the edge to the temporary stack
-        EdgeList.pop_back();
+// Marks a vertex (0-based) as a link
+void ClusterFinder::addLink(int indexVertex) {
+    if (!isLink[indexVertex]) {
+        isLink[indexVertex] = 1;
+        nLinks++;
     }
+}
+
+// Pops the edges of a cluster from the edge stack, down to and including the edge stored
+// at position treeEdge of the graph (the whole stack when it is NO_EDGE), and labels them
+// with a new cluster number
+void ClusterFinder::findClusters(const CSRGraph &graph, uint32_t treeEdge) {
+    nClusters++;
+    clusterVertices.clear();
+
+    while (!edgeStack.empty()) {
+        StackedEdge edge = edgeStack.back();
+        edgeStack.pop_back();
+        blockOf[graph.edges[edge.position]] = nClusters;
+
+        if (buildClusters) {
+            uint32_t endpoints[2] = {edge.source, graph.targets[edge.position]};
+            for (uint32_t vertex : endpoints) {
+                if (clusterMark[vertex] != nClusters) {
+                    clusterMark[vertex] = nClusters;
+                    clusterVertices.push_back(vertex + 1);
+                }
+            }
+        }
 
-    // If we found the starting edge, add it to the temporary stack
-    if (!EdgeList.empty()) {
-        tempEdgeList.push_front(EdgeList.back());
-        EdgeList.pop_back();
+        if (edge.position == treeEdge) break;
     }
 
-    // Now, tempEdgeList contains the edges of the current cluster in reverse order
-    // Add Vertexs to the cluster in the correct order
-    while (!tempEdgeList.empty()) {
-        Edge edge = tempEdgeList.front();
-        tempEdgeList.pop_front();
-        clusterVertices.insert(edge.first);
-        clusterVertices.insert(edge.second);
+    if (buildClusters) {
+        sort(clusterVertices.begin(), clusterVertices.end());
+        clusterMembers.insert(clusterMembers.end(), clusterVertices.begin(), clusterVertices.end());
+        clusterOffsets.push_back((uint32_t)clusterMembers.size());
     }
+}
 
-    // Add the cluster to the set of clusters
-    clusters.insert(clusterVertices);
-    nClusters++;
+// Stable counting sort of the clusters in input by their vertex at index rank
+void ClusterFinder::countingSortClusters(const vector<uint32_t> &input, vector<uint32_t> &output, int nVertexs, int rank) {
+    counts.assign(nVertexs + 2, 0);
+    for (uint32_t c : input) {
+        counts[clusterMembers[clusterOffsets[c] + rank] + 1]++;
+    }
+    for (int v = 1; v <= nVertexs + 1; v++) {
+        counts[v] += counts[v-1];
+    }
+    for (uint32_t c : input) {
+        output[counts[clusterMembers[clusterOffsets[c] + rank]]++] = c;
+    }
 }
 
-// Depth-first search to identify articulation points and clusters
-void dfs(vector<vector<int>> &Graph, int indexVertex, int parent, int time) {
-    time++;
-    vertices[indexVertex].updateDiscoveryTime(time); 
-    vertices[indexVertex].updateLowLink(time); 
-    int children = 0;
-    vector<int>& adjacentes = Graph[indexVertex];
+// Returns the clusters in lexicographic order. Ou seja, se temos os clusters a = {1, 3, 7} e
+// b = {1, 2, 100}, o cluster b deve ser listado antes do cluster a, e, portanto, possuir um
+// identificador menor. Every cluster has at least two vertices and two clusters share at most
+// one vertex, so the first two vertices already decide the order and a radix sort on them
+// (second vertex, then first) is enough. Runs with the same first two vertices cannot come
+// from biconnected components, but are still finished by a full comparison to keep the order exact.
+const vector<uint32_t> &ClusterFinder::sortClusters(int nVertexs) {
+    order.resize(nClusters);
+    sorted.resize(nClusters);
+    for (int c = 0; c < nClusters; c++) {
+        order[c] = c;
+    }
+    countingSortClusters(order, sorted, nVertexs, 1);
+    countingSortClusters(sorted, order, nVertexs, 0);
+
+    auto firstTwo = [this](uint32_t c) {
+        return make_pair(clusterMembers[clusterOffsets[c]], clusterMembers[clusterOffsets[c] + 1]);
+    };
+    for (int begin = 0, end; begin < nClusters; begin = end) {
+        for (end = begin + 1; end < nClusters && firstTwo(order[end]) == firstTwo(order[begin]); end++);
+        if (end - begin > 1) {
+            sort(order.begin() + begin, order.begin() + end, [this](uint32_t a, uint32_t b) {
+                return lexicographical_compare(clusterMembers.begin() + clusterOffsets[a], clusterMembers.begin() + clusterOffsets[a+1],
+                                               clusterMembers.begin() + clusterOffsets[b], clusterMembers.begin() + clusterOffsets[b+1]);
+            });
+        }
+    }
+    return order;
+}
 
-    for(int i = 0; i < (int)adjacentes.size(); i++) {
-        if(vertices[adjacentes[i]-1].discoveryTime == 0) { 
-            children++;
-            EdgeList.push_back(make_pair(indexVertex+1, adjacentes[i])); 
+// Updates the parent after the DFS of one of its children has finished. treeEdge is
+// the position in the graph of the edge from the parent to the child.
+void ClusterFinder::finishChild(const CSRGraph &graph, int indexVertex, int parent, int child, uint32_t treeEdge, int children) {
+    if(vertices[child].lowLink < vertices[indexVertex].lowLink) {
+        vertices[indexVertex].updateLowLink(vertices[child].lowLink);
+    }
 
-            dfs(Graph, adjacentes[i]-1, indexVertex+1, time);
+    if(parent != -1 && vertices[child].lowLink >= vertices[indexVertex].discoveryTime) {
+        addLink(indexVertex);
+    }
 
-            if(vertices[adjacentes[i]-1].lowLink < vertices[indexVertex].lowLink) {
-                vertices[indexVertex].updateLowLink(vertices[adjacentes[i]-1].lowLink);
-            }
-            
-            if(parent != -1 && vertices[adjacentes[i]-1].lowLink >= vertices[indexVertex].discoveryTime) {
-                links.insert(indexVertex+1);               
-            }
+    if((vertices[indexVertex].discoveryTime == 1 && children > 1) || (vertices[indexVertex].discoveryTime > 1 && vertices[child].lowLink >= vertices[indexVertex].discoveryTime)) {
+        findClusters(graph, treeEdge);
+    }
+}
 
-            if((vertices[indexVertex].discoveryTime == 1 && children > 1) || (vertices[indexVertex].discoveryTime > 1 && vertices[adjacentes[i]-1].lowLink >= vertices[indexVertex].discoveryTime)) {
-                findClusters(indexVertex+1, adjacentes[i]);
+// Depth-first search to identify articulation points and clusters.
+// The traversal uses an explicit stack instead of recursion, so long path-like graphs
+// do not overflow the call stack.
+void ClusterFinder::dfs(const CSRGraph &graph, int root, int time) {
+    int children = 0; // Children of the root in the DFS tree
+    time++;
+    vertices[root].updateDiscoveryTime(time);
+    vertices[root].updateLowLink(time);
+    dfsStack.push_back({(uint32_t)root, graph.offsets[root]});
+
+    while (!dfsStack.empty()) {
+        int depth = (int)dfsStack.size() - 1;
+        int indexVertex = dfsStack[depth].vertex;
+        int parent = depth > 0 ? (int)dfsStack[depth-1].vertex : -1;
+        // The parent frame already moved past the tree edge to this vertex
+        uint32_t parentEdge = depth > 0 ? graph.edges[dfsStack[depth-1].next - 1] : NO_EDGE;
+
+        if (dfsStack[depth].next == graph.offsets[indexVertex+1]) {
+            // All adjacent vertices were visited: return to the parent
+            dfsStack.pop_back();
+            if (depth > 0) {
+                int grandParent = depth > 1 ? (int)dfsStack[depth-2].vertex : -1;
+                finishChild(graph, parent, grandParent, indexVertex, dfsStack[depth-1].next - 1, children);
             }
+            continue;
+        }
 
-        } else if(adjacentes[i] != parent) { 
-            if(vertices[adjacentes[i]-1].discoveryTime < vertices[indexVertex].lowLink) {
-                vertices[indexVertex].updateLowLink(vertices[adjacentes[i]-1].discoveryTime);
+        uint32_t position = dfsStack[depth].next++;
+        int adjacente = graph.targets[position];
+        if(vertices[adjacente].discoveryTime == 0) {
+            if (parent == -1) children++;
+            edgeStack.push_back({(uint32_t)indexVertex, position});
+
+            int childTime = vertices[indexVertex].discoveryTime + 1;
+            vertices[adjacente].updateDiscoveryTime(childTime);
+            vertices[adjacente].updateLowLink(childTime);
+            dfsStack.push_back({(uint32_t)adjacente, graph.offsets[adjacente]});
+
+        } else if(graph.edges[position] != parentEdge) {
+            // Only the tree edge is skipped, so parallel edges to the parent are labeled too
+            if(vertices[adjacente].discoveryTime < vertices[indexVertex].lowLink) {
+                vertices[indexVertex].updateLowLink(vertices[adjacente].discoveryTime);
             }
-            if(vertices[adjacentes[i]-1].discoveryTime < vertices[indexVertex].discoveryTime) {
-                EdgeList.push_back(make_pair(indexVertex+1, adjacentes[i]));
+            if(vertices[adjacente].discoveryTime < vertices[indexVertex].discoveryTime) {
+                edgeStack.push_back({(uint32_t)indexVertex, position});
             }
         }
     }
 
-    if(parent == -1 && children > 1) {
-        links.insert(indexVertex+1);      
+    if(children > 1) {
+        addLink(root);
     }
 }
 
+// Builds the CSR graph from the edge list (pairs of 1-based endpoints) in two passes:
+// the degrees are counted and turned into offsets by a prefix sum, then the edges are
+// written backwards, moving each offset from the end to the start of its vertex. This
+// keeps the adjacent vertices in input order without a second array of positions.
+void buildGraph(CSRGraph &graph, int nVertexs, const vector<uint32_t> &endpoints) {
+    graph.offsets.assign(nVertexs + 1, 0);
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        graph.offsets[endpoints[i] - 1]++;
+    }
+    for (int v = 1; v <= nVertexs; v++) {
+        graph.offsets[v] += graph.offsets[v-1];
+    }
 
-int main() {
-    int nVertexs, nEdges;
+    graph.targets.resize(endpoints.size());
+    graph.edges.resize(endpoints.size());
+    for (size_t i = endpoints.size(); i > 0; i -= 2) {
+        uint32_t Vertex1 = endpoints[i-2] - 1, Vertex2 = endpoints[i-1] - 1;
+        uint32_t edge = (uint32_t)(i/2 - 1);
+        uint32_t position = --graph.offsets[Vertex2];
+        graph.targets[position] = Vertex1;
+        graph.edges[position] = edge;
+        position = --graph.offsets[Vertex1];
+        graph.targets[position] = Vertex2;
+        graph.edges[position] = edge;
+    }
+}
+
+void ClusterFinder::run(const CSRGraph &graph, int nVertexs) {
+    // Perform DFS to identify articulation points and clusters
     int time = 0;
-    if (scanf("%d %d", &nVertexs, &nEdges) != 2) {
-        fprintf(stderr, "Error reading nVertexs and nEdges\n");
-        return 1;
+    for (int i = 0; i < nVertexs; i++) {
+        if (vertices[i].discoveryTime == 0) {
+            dfs(graph, i, time);
+        }
+        if (!edgeStack.empty()) {
+            findClusters(graph, NO_EDGE);
+        }
     }
-    vector<vector<int>> Graph(nVertexs);
-    vertices.resize(nVertexs);
+}
 
-    // Read edges of the graph
+// Reads the edges (pairs of 1-based endpoints) of the graph
+template <class Reader>
+bool readEdges(Reader &reader, int nVertexs, int nEdges, vector<uint32_t> &endpoints) {
+    if (nVertexs < 0 || nEdges < 0) {
+        fprintf(stderr, "Invalid nVertexs and nEdges: %d %d\n", nVertexs, nEdges);
+        return false;
+    }
+
+    endpoints.resize(2 * (size_t)nEdges);
     for (int i = 0; i < nEdges; i++) {
         int Vertex1, Vertex2;
-        if (scanf("%d %d", &Vertex1, &Vertex2) != 2) {
+        if (!reader.readInt(Vertex1) || !reader.readInt(Vertex2) ||
+            Vertex1 < 1 || Vertex1 > nVertexs || Vertex2 < 1 || Vertex2 > nVertexs) {
             fprintf(stderr, "Error reading Vertex1 and Vertex2 at iteration %d\n", i);
-            return 1;
+            return false;
         }
 
-        Graph[Vertex1 - 1].push_back(Vertex2);
-        Graph[Vertex2 - 1].push_back(Vertex1);
+        endpoints[2*i] = Vertex1;
+        endpoints[2*i+1] = Vertex2;
     }
+    return true;
+}
 
-    // Perform DFS to identify articulation points and clusters
-    for (int i = 0; i < nVertexs; i++) {
-        if (vertices[i].discoveryTime == 0) {
-            dfs(Graph, i, -1, time);
-        }
-        if (!EdgeList.empty()) {
-            set<int> clusterVertices;
-            while (!EdgeList.empty()) {
-                clusterVertices.insert(EdgeList.back().first);
-                clusterVertices.insert(EdgeList.back().second);
-                EdgeList.pop_back();
-            }
-            clusters.insert(clusterVertices);
-            nClusters++;
-        }
+// Reads the number of vertices and the edges of the graph
+template <class Reader>
+bool readGraph(Reader &reader, int &nVertexs, int &nEdges, vector<uint32_t> &endpoints) {
+    if (!reader.readInt(nVertexs) || !reader.readInt(nEdges)) {
+        fprintf(stderr, "Error reading nVertexs and nEdges\n");
+        return false;
     }
+    return readEdges(reader, nVertexs, nEdges, endpoints);
+}
+
+// Outputs the cluster of each edge, in input order
+template <class Writer>
+void printLabels(Writer &writer, const ClusterFinder &finder, int nEdges) {
+    writer.writeInt(finder.nClusters);
+    writer.writeChar('\n');
+    for (int e = 0; e < nEdges; e++) {
+        writer.writeInt(finder.blockOf[e]);
+        writer.writeChar('\n');
+    }
+}
 
+// Outputs the articulation points, the clusters and the forest
+template <class Writer>
+void printResult(Writer &writer, ClusterFinder &finder, int nVertexs, const vector<uint32_t> &order) {
     // Output the number of articulation points
-    printf("%d\n", (int)links.size());
-    for(set<int>::iterator itr = links.begin(); itr != links.end(); itr++) {
-        printf("%d\n", *itr);
+    writer.writeInt(finder.nLinks);
+    writer.writeChar('\n');
+    for (int v = 0; v < nVertexs; v++) {
+        if (finder.isLink[v]) {
+            writer.writeInt(v+1);
+            writer.writeChar('\n');
+        }
     }
 
     // Output the number of clusters
-    printf("%d\n", nClusters);
-
-    int i = 1;
-    int j = 1;
-    int nEdgesForest = 0;
-
-    // Output clusters
-    set<set<int>>::iterator itr1;
-    set<int>::iterator itr;
-    for(itr1 = clusters.begin(); itr1 != clusters.end(); itr1++) {
-        printf("%d %lu ", nVertexs+i, itr1->size());
-
-        itr = itr1->begin(); 
-        while (itr != itr1->end()) {
-            if(links.find(*itr) != links.end()) {
-                set<int> elemForest;
-                elemForest.insert(nVertexs+i);
-                elemForest.insert(*itr);
-                forest.insert(elemForest);
-                nEdgesForest++;
-            }
-            if(j == (int)itr1->size()) printf("%d\n", *itr);
-            else printf("%d ", *itr);
-            j++;
-            itr++;
+    writer.writeInt(finder.nClusters);
+    writer.writeChar('\n');
+
+    // Output clusters, counting for each link how many clusters contain it
+    vector<uint32_t> &forestOffsets = finder.forestOffsets;
+    forestOffsets.assign(nVertexs + 1, 0);
+    for (int i = 0; i < finder.nClusters; i++) {
+        uint32_t c = order[i];
+        writer.writeInt(nVertexs+i+1);
+        writer.writeChar(' ');
+        writer.writeInt(finder.clusterOffsets[c+1] - finder.clusterOffsets[c]);
+        writer.writeChar(' ');
+        for (uint32_t k = finder.clusterOffsets[c]; k < finder.clusterOffsets[c+1]; k++) {
+            uint32_t vertex = finder.clusterMembers[k];
+            if (finder.isLink[vertex-1]) forestOffsets[vertex]++;
+            writer.writeInt(vertex);
+            writer.writeChar(k+1 == finder.clusterOffsets[c+1] ? '\n' : ' ');
+        }
+    }
+
+    // The forest has an edge between each link and each cluster containing it, listed by
+    // link and then by cluster. Walking the clusters in output order and bucketing the edges
+    // by link (offsets from the counts above) produces them already in that order.
+    for (int v = 1; v <= nVertexs; v++) {
+        forestOffsets[v] += forestOffsets[v-1];
+    }
+    int nEdgesForest = (int)forestOffsets[nVertexs];
+    vector<uint32_t> &forestClusters = finder.forestClusters, &position = finder.forestPosition;
+    forestClusters.resize(nEdgesForest);
+    position.assign(forestOffsets.begin(), forestOffsets.end() - 1);
+    for (int i = 0; i < finder.nClusters; i++) {
+        uint32_t c = order[i];
+        for (uint32_t k = finder.clusterOffsets[c]; k < finder.clusterOffsets[c+1]; k++) {
+            uint32_t vertex = finder.clusterMembers[k];
+            if (finder.isLink[vertex-1]) forestClusters[position[vertex-1]++] = nVertexs+i+1;
         }
-        j = 1;
-        i++;
     }
 
     // Output forest
-    printf("%d %d\n", nClusters+(int)links.size(), nEdgesForest);
-    for(itr1 = forest.begin(); itr1 != forest.end(); itr1++) {
-        printf("%d %d\n", *(itr1->begin()), *(itr1->rbegin()));
+    writer.writeInt(finder.nClusters+finder.nLinks);
+    writer.writeChar(' ');
+    writer.writeInt(nEdgesForest);
+    writer.writeChar('\n');
+    for (int v = 0; v < nVertexs; v++) {
+        for (uint32_t k = forestOffsets[v]; k < forestOffsets[v+1]; k++) {
+            writer.writeInt(v+1);
+            writer.writeChar(' ');
+            writer.writeInt(forestClusters[k]);
+            writer.writeChar('\n');
+        }
+    }
+}
+
+template <class Reader, class Writer>
+int run(const char *inputPath, bool labelsOutput) {
+    int nVertexs, nEdges;
+
+    Reader reader;
+    if (!reader.open(inputPath)) {
+        fprintf(stderr, "Error opening %s\n", inputPath);
+        return 1;
+    }
+
+    // Read edges of the graph
+    vector<uint32_t> endpoints;
+    if (!readGraph(reader, nVertexs, nEdges, endpoints)) {
+        return 1;
+    }
+    ClusterFinder finder;
+    finder.reset(nVertexs, nEdges, !labelsOutput);
+
+    CSRGraph graph;
+    buildGraph(graph, nVertexs, endpoints);
+    vector<uint32_t>().swap(endpoints);
+
+    finder.run(graph, nVertexs);
+
+    Writer writer;
+    if (labelsOutput) {
+        printLabels(writer, finder, nEdges);
+        writer.flush();
+        return 0;
     }
 
+    const vector<uint32_t> &order = finder.sortClusters(nVertexs);
+    printResult(writer, finder, nVertexs, order);
+    writer.flush();
     return 0;
 }
 
+// One graph of a batch: its edges as read and its formatted output. Slots are reused for
+// the following graphs, keeping the memory of both vectors.
+struct BatchGraph {
+    int nVertexs;
+    int nEdges;
+    vector<uint32_t> endpoints;
+    vector<char> output;
+};
+
+// Buffers owned by one batch worker, reused for every graph it solves
+struct BatchWorker {
+    ClusterFinder finder;
+    CSRGraph graph;
+};
+
+void solveBatchGraph(BatchWorker &worker, BatchGraph &instance, bool labelsOutput) {
+    worker.finder.reset(instance.nVertexs, instance.nEdges, !labelsOutput);
+    buildGraph(worker.graph, instance.nVertexs, instance.endpoints);
+    worker.finder.run(worker.graph, instance.nVertexs);
+
+    instance.output.clear();
+    BufferWriter writer(instance.output);
+    if (labelsOutput) {
+        printLabels(writer, worker.finder, instance.nEdges);
+    } else {
+        printResult(writer, worker.finder, instance.nVertexs, worker.finder.sortClusters(instance.nVertexs));
+    }
+    writer.writeChar('\n'); // A blank line ends the output of every graph
+}
+
+// Reads graphs until the end of the input and prints the result of each one followed by a
+// blank line. Graphs are read a window at a time; the graphs of a window are independent, so
+// they are solved by the workers of the pool in any order and printed in input order after it.
+template <class Reader, class Writer>
+int runBatch(const char *inputPath, bool labelsOutput, int nWorkers) {
+    Reader reader;
+    if (!reader.open(inputPath)) {
+        fprintf(stderr, "Error opening %s\n", inputPath);
+        return 1;
+    }
+
+    ThreadPool pool(nWorkers);
+
+    vector<BatchWorker> workers(pool.size());
+    vector<BatchGraph> window(4 * pool.size());
+    Writer writer;
+    bool failed = false;
+    for (int first = 0; !failed;) {
+        size_t count = 0;
+        while (count < window.size()) {
+            BatchGraph &instance = window[count];
+            if (!reader.readInt(instance.nVertexs)) break;
+            if (!reader.readInt(instance.nEdges) || !readEdges(reader, instance.nVertexs, instance.nEdges, instance.endpoints)) {
+                fprintf(stderr, "Error reading graph %d\n", first + (int)count + 1);
+                failed = true;
+                break;
+            }
+            count++;
+        }
+        if (count == 0) break;
+
+        pool.parallelFor(count, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                solveBatchGraph(workers[worker], window[i], labelsOutput);
+            }
+        }, 1);
+        for (size_t i = 0; i < count; i++) {
+            writer.writeBytes(window[i].output.data(), window[i].output.size());
+        }
+        writer.flush();
+        first += (int)count;
+    }
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool labelsOutput = false;
+    bool fastIO = false;
+    const char *inputPath = nullptr;
+    bool batch = false;
+    int nWorkers = 1;
+
+    // -d prints articulation points, clusters and forest (default), -l prints only the cluster of each edge.
+    // -f reads and writes through memory buffers instead of scanf/printf; -i reads the graph from a file instead of stdin.
+    // -b reads graphs until the end of the input and prints each result followed by a blank line;
+    // -j solves the graphs of a batch on the given number of threads.
+    int option;
+    while ((option = getopt(argc, argv, "dlfi:bj:")) != -1) {
+        switch (option) {
+        case 'd':
+            labelsOutput = false;
+            break;
+        case 'l':
+            labelsOutput = true;
+            break;
+        case 'f':
+            fastIO = true;
+            break;
+        case 'i':
+            inputPath = optarg;
+            break;
+        case 'b':
+            batch = true;
+            break;
+        case 'j':
+            nWorkers = atoi(optarg);
+            if (nWorkers < 1) {
+                fprintf(stderr, "Invalid number of threads: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d | -l | -b [-j workers]] [-f] [-i input] < input\n", argv[0]);
+            return 1;
+        }
+    }
+    if (batch) {
+        if (fastIO) {
+            return runBatch<FastReader, FastWriter>(inputPath, labelsOutput, nWorkers);
+        }
+        return runBatch<StdioReader, StdioWriter>(inputPath, labelsOutput, nWorkers);
+    }
+    if (fastIO) {
+        return run<FastReader, FastWriter>(inputPath, labelsOutput);
+    }
+    return run<StdioReader, StdioWriter>(inputPath, labelsOutput);
+}